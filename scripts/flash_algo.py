@@ -67,10 +67,21 @@ class PackFlashAlgo(object):
 
     EXTRA_SYMBOLS = set([
         "BlankCheck",
+        "Crc32",
         "EraseChip",
         "Verify",
     ])
 
+    # struct FlashStats in source/FlashStats.h, present in FLASH_STATS builds
+    FLASH_STATS_SYMBOL = "FlashStats"
+    FLASH_STATS_ENTRIES = ("Init", "UnInit", "EraseChip", "EraseSector",
+                           "ProgramPage")
+    FLASH_STATS_STRUCT = "<LL" + "LLLL" * len(FLASH_STATS_ENTRIES)
+    FLASH_STATS_COUNTERS = ("DWT", "SysTick")
+
+    # Absolute symbol defined by the make_gcc_arm build profiles
+    PROFILE_SYMBOL_PREFIX = "FlashAlgoProfile_"
+
     def __init__(self, data):
         """Construct a PackFlashAlgorithm from an ElfFileSimple"""
         self.elf = ElfFileSimple(data)
@@ -109,6 +120,45 @@ class PackFlashAlgo(object):
 
         self.algo_data = _create_algo_bin(ro_rw_zi)
 
+        # Offset of the FlashStats struct in the algo, None if not built in
+        self.flash_stats = None
+        self.flash_stats_size = 0
+        if self.FLASH_STATS_SYMBOL in self.elf.symbols:
+            stats = self.elf.symbols[self.FLASH_STATS_SYMBOL]
+            self.flash_stats = stats.value
+            self.flash_stats_size = struct.calcsize(self.FLASH_STATS_STRUCT)
+
+        # Build profile of make_gcc_arm builds, None for other tools
+        self.profile = None
+        for name in self.elf.symbols:
+            if name.startswith(self.PROFILE_SYMBOL_PREFIX):
+                self.profile = name[len(self.PROFILE_SYMBOL_PREFIX):]
+
+    def parse_flash_stats(self, data):
+        """
+        Decode the FlashStats struct read back from the target after a session
+
+        :param data: flash_stats_size bytes read from the flash_stats offset
+            of the loaded algo
+        :return: dict with the counter used and, per function, the calls,
+            total, max and busy cycles
+        """
+        values = struct.unpack(self.FLASH_STATS_STRUCT,
+                               data[:self.flash_stats_size])
+        result = {
+            "version": values[0],
+            "counter": self.FLASH_STATS_COUNTERS[values[1]],
+        }
+        for i, name in enumerate(self.FLASH_STATS_ENTRIES):
+            calls, cycles, max_cycles, busy = values[2 + 4 * i:6 + 4 * i]
+            result[name] = {
+                "calls": calls,
+                "cycles": cycles,
+                "max": max_cycles,
+                "busy": busy,
+            }
+        return result
+
     def format_algo_data(self, spaces, group_size, fmt):
         """"
         Return a string representing algo_data suitable for use in a template
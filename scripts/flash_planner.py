@@ -0,0 +1,343 @@
+#!/usr/bin/env python
+"""
+ mbed
+ Copyright (c) 2017-2017 ARM Limited
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+
+This script turns an image and the flash description of an algorithm into
+a programming plan: chip erase or sector erase, the coalesced erase ranges,
+the pages to program and the sectors that can be skipped because their
+contents already match. The plan is written as JSON so a probe firmware or
+a host driver can execute it operation by operation.
+"""
+
+from __future__ import print_function
+import os
+import json
+import zlib
+import argparse
+import logging
+
+from elftools.elf.elffile import ELFFile
+from flash_algo import ElfFileSimple, PackFlashInfo
+
+logger = logging.getLogger(__name__)
+logger.addHandler(logging.NullHandler())
+
+
+def str_to_num(val):
+    return int(val, 0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Programming planner")
+    parser.add_argument("algo", help="Elf, axf, or flm of the flash algo")
+    parser.add_argument("image", help="Image to program (bin, hex or elf)")
+    parser.add_argument("--base", type=str_to_num, default=None,
+                        help="Load address of a bin image, default flash start")
+    parser.add_argument("--erase", choices=("auto", "chip", "sector"),
+                        default="auto", help="Erase method, auto picks the "
+                        "faster one")
+    parser.add_argument("--timing", help="JSON file with measured "
+                        "erase_chip_ms, erase_sector_ms and program_page_ms, "
+                        "FlashDev timeouts are used for missing entries and "
+                        "an unmeasured chip erase costs as much as erasing "
+                        "every sector")
+    parser.add_argument("--banks", type=str_to_num, nargs="+", default=[],
+                        help="Start addresses of the flash banks after the "
+                        "first one, operations are interleaved across banks")
+    parser.add_argument("--previous", help="Plan or analyzer output holding "
+                        "the sector CRCs currently in flash")
+    parser.add_argument("-o", "--output", help="Output file, default stdout")
+    args = parser.parse_args()
+
+    with open(args.algo, "rb") as file_handle:
+        flash_info = PackFlashInfo(ElfFileSimple(file_handle.read()))
+
+    timing = {}
+    if args.timing:
+        with open(args.timing) as file_handle:
+            timing = json.load(file_handle)
+
+    previous = None
+    if args.previous:
+        with open(args.previous) as file_handle:
+            previous = _load_sector_crcs(json.load(file_handle))
+
+    base = flash_info.start if args.base is None else args.base
+    segments = load_image(args.image, base)
+
+    planner = FlashPlanner(flash_info, timing, args.banks)
+    plan = planner.plan(segments, args.erase, previous)
+
+    text = json.dumps(plan, indent=2, sort_keys=True)
+    if args.output:
+        with open(args.output, "w") as file_handle:
+            file_handle.write(text + "\n")
+    else:
+        print(text)
+
+
+def load_image(path, base):
+    """
+    Load an image as a list of (address, bytearray) segments
+
+    :param path: bin, Intel hex or elf file
+    :param base: load address of a bin file
+    """
+    ext = os.path.splitext(path)[1].lower()
+    if ext == ".bin":
+        with open(path, "rb") as file_handle:
+            return [(base, bytearray(file_handle.read()))]
+    if ext in (".hex", ".ihex"):
+        with open(path) as file_handle:
+            return _load_hex(file_handle)
+    with open(path, "rb") as file_handle:
+        return _load_elf(ELFFile(file_handle))
+
+
+def _load_hex(file_handle):
+    """Read the data records of an Intel hex file"""
+    segments = []
+    upper = 0
+    for line in file_handle:
+        line = line.strip()
+        if not line:
+            continue
+        if line[0] != ":":
+            raise Exception("Invalid hex record %s" % line)
+        record = bytearray.fromhex(line[1:])
+        if sum(record) & 0xFF != 0:
+            raise Exception("Hex record checksum error %s" % line)
+        length, offset, rtype = record[0], record[1] << 8 | record[2], record[3]
+        data = record[4:4 + length]
+        if rtype == 0x00:
+            address = upper + offset
+            if segments and segments[-1][0] + len(segments[-1][1]) == address:
+                segments[-1][1].extend(data)
+            else:
+                segments.append((address, bytearray(data)))
+        elif rtype == 0x01:
+            break
+        elif rtype == 0x02:
+            upper = (data[0] << 8 | data[1]) << 4
+        elif rtype == 0x04:
+            upper = (data[0] << 8 | data[1]) << 16
+    return segments
+
+
+def _load_elf(elf):
+    """Read the loadable segments of an elf file at their load address"""
+    segments = []
+    for segment in elf.iter_segments():
+        if segment["p_type"] != "PT_LOAD" or segment["p_filesz"] == 0:
+            continue
+        segments.append((segment["p_paddr"], bytearray(segment.data())))
+    return segments
+
+
+def _load_sector_crcs(data):
+    """Return {sector address: crc} from a previous plan or analyzer output"""
+    crcs = data.get("sector_crcs", data)
+    return dict((int(address, 0), crc) for address, crc in crcs.items())
+
+
+def sector_crc(data):
+    """CRC of a sector, same as computed by the target side analyzer"""
+    return zlib.crc32(bytes(data)) & 0xFFFFFFFF
+
+
+class FlashPlanner(object):
+    """
+    Class to plan the erase and program operations for an image
+
+    The cost of each method is estimated from the timing. The host runs one
+    algo call at a time, so per sector erase times add up over all banks.
+    """
+
+    def __init__(self, flash_info, timing=None, banks=()):
+        """
+        Construct a FlashPlanner
+
+        :param flash_info: PackFlashInfo of the algo
+        :param timing: dict with erase_chip_ms, erase_sector_ms and
+            program_page_ms, defaults from the FlashDev timeouts except for
+            erase_chip_ms which defaults to erasing every sector
+        :param banks: start addresses of the banks after the first one
+        """
+        timing = timing or {}
+        self.flash_info = flash_info
+        self.start = flash_info.start
+        self.end = flash_info.start + flash_info.size
+        self.page_size = flash_info.page_size
+        self.empty = flash_info.value_empty & 0xFF
+        self.erase_sector_ms = timing.get("erase_sector_ms",
+                                          flash_info.erase_timeout_ms)
+        self.program_page_ms = timing.get("program_page_ms",
+                                          flash_info.prog_timeout_ms)
+        self.banks = sorted(set([self.start] + list(banks)))
+        self.sectors = list(self._sector_itr())
+        # The FlashDev erase timeout is per sector and says nothing about
+        # EraseChip, so without a measurement it is never assumed faster
+        self.erase_chip_ms = timing.get("erase_chip_ms",
+                                        self._erase_ms(self.sectors))
+
+    def _sector_itr(self):
+        """Iterator which returns the address and size of each sector"""
+        regions = [(self.start + start, size) for start, size in
+                   self.flash_info.sector_info_list]
+        regions.append((self.end, 0))
+        for (start, size), (next_start, _) in zip(regions, regions[1:]):
+            for address in range(start, next_start, size):
+                yield address, size
+
+    def bank(self, address):
+        """Index of the bank holding address"""
+        return len([start for start in self.banks if start <= address]) - 1
+
+    def plan(self, segments, erase="auto", previous=None):
+        """
+        Build the plan for an image
+
+        :param segments: list of (address, bytearray) from load_image
+        :param erase: "auto", "chip" or "sector"
+        :param previous: {sector address: crc} of the current flash contents
+        :return: plan as a dict ready for json
+        """
+        previous = previous or {}
+        contents = self._sector_contents(segments)
+
+        crcs = {}
+        changed = []
+        for address, size in self.sectors:
+            if address not in contents:
+                continue
+            crcs[address] = sector_crc(contents[address])
+            if previous.get(address) != crcs[address]:
+                changed.append((address, size))
+
+        all_sectors = [(address, size) for address, size in self.sectors
+                       if address in contents]
+        estimate = {
+            "chip": (self.erase_chip_ms +
+                     self._program_ms(contents, all_sectors)),
+            "sector": (self._erase_ms(changed) +
+                       self._program_ms(contents, changed)),
+        }
+        if erase == "auto":
+            erase = "chip" if estimate["chip"] < estimate["sector"] else "sector"
+
+        operations = []
+        if erase == "chip":
+            operations.append({"op": "erase_chip"})
+            to_program = all_sectors
+        else:
+            operations.extend(self._erase_operations(changed))
+            to_program = changed
+        operations.extend(self._program_operations(contents, to_program))
+
+        return {
+            "flash_start": "0x%x" % self.start,
+            "flash_size": "0x%x" % (self.end - self.start),
+            "page_size": "0x%x" % self.page_size,
+            "erase": erase,
+            "estimate_ms": estimate,
+            "skipped_sectors": len(all_sectors) - len(to_program),
+            "operations": operations,
+            "sector_crcs": dict(("0x%x" % address, crc)
+                                for address, crc in crcs.items()),
+        }
+
+    def _sector_contents(self, segments):
+        """Return {sector address: bytearray} of the sectors touched by the image"""
+        contents = {}
+        for address, data in segments:
+            if address < self.start or address + len(data) > self.end:
+                raise Exception("Image 0x%x-0x%x is outside of flash" %
+                                (address, address + len(data)))
+            for start, size in self.sectors:
+                lo = max(start, address)
+                hi = min(start + size, address + len(data))
+                if lo >= hi:
+                    continue
+                sector = contents.setdefault(start,
+                                             bytearray([self.empty]) * size)
+                sector[lo - start:hi - start] = data[lo - address:hi - address]
+        return contents
+
+    def _pages(self, contents, address, size):
+        """Iterator over the pages of a sector which are not blank"""
+        sector = contents[address]
+        for offset in range(0, size, self.page_size):
+            page = sector[offset:offset + self.page_size]
+            if page != bytearray([self.empty]) * len(page):
+                yield address + offset, len(page)
+
+    def _program_ms(self, contents, sectors):
+        return sum(len(list(self._pages(contents, address, size)))
+                   for address, size in sectors) * self.program_page_ms
+
+    def _erase_ms(self, sectors):
+        return len(sectors) * self.erase_sector_ms
+
+    def _erase_operations(self, sectors):
+        """Coalesce sectors into erase ranges, interleaved across banks"""
+        ranges = [[] for _ in self.banks]
+        for address, size in sectors:
+            bank_ranges = ranges[self.bank(address)]
+            if bank_ranges and bank_ranges[-1]["end"] == address:
+                bank_ranges[-1]["end"] += size
+                bank_ranges[-1]["sectors"] += 1
+            else:
+                bank_ranges.append({"start": address, "end": address + size,
+                                    "sectors": 1})
+
+        operations = [[] for _ in self.banks]
+        for bank, bank_ranges in enumerate(ranges):
+            for erase_range in bank_ranges:
+                operations[bank].append({
+                    "op": "erase_sectors",
+                    "bank": bank,
+                    "address": "0x%x" % erase_range["start"],
+                    "size": "0x%x" % (erase_range["end"] - erase_range["start"]),
+                    "sectors": erase_range["sectors"],
+                })
+        return _interleave(operations)
+
+    def _program_operations(self, contents, sectors):
+        """Program the pages of the sectors which are not blank, interleaved across banks"""
+        operations = [[] for _ in self.banks]
+        for address, size in sectors:
+            for page, page_size in self._pages(contents, address, size):
+                bank = self.bank(page)
+                operations[bank].append({
+                    "op": "program_page",
+                    "bank": bank,
+                    "address": "0x%x" % page,
+                    "size": "0x%x" % page_size,
+                })
+        return _interleave(operations)
+
+
+def _interleave(lists):
+    """Round robin over the per bank operation lists"""
+    merged = []
+    for i in range(max(len(items) for items in lists)):
+        merged.extend(items[i] for items in lists if i < len(items))
+    return merged
+
+
+if __name__ == '__main__':
+    main()
@@ -22,6 +22,7 @@ loaded into the target MCU RAM. Generates files compatible with C programs
 and python programs (DAPLink Interface Firmware and pyDAPFlash)
 '''
 import os
+import struct
 import argparse
 from flash_algo import PackFlashAlgo
 
@@ -32,15 +33,117 @@ HEADER_SIZE = 0x20
 
 STACK_SIZE = 0x200
 
+# Sector CRC analyzer, position independent Thumb code (ARMv6-M and up)
+#   uint32_t Analyze(uint32_t adr, uint32_t sz, uint32_t *crc_table)
+# Walks the sectors of [adr, adr + sz), clipped to the end of flash, and
+# stores the CRC32 (IEEE 802.3, same as zlib.crc32) of each whole sector
+# to crc_table. Returns the number of CRCs written. adr is expected to be
+# sector aligned. The code is followed by ANALYZER_CRC_NIBBLES, the flash
+# end address and the sector map: (start, size) pairs terminated by
+# (flash end, 0).
+#
+#       push  {r2, r4-r7, lr}
+#       adds  r1, r0, r1            ; clip adr + sz to the flash end
+#       ldr   r3, flash_end
+#       cmp   r1, r3
+#       bls   sector
+#       mov   r1, r3
+#   sector:
+#       cmp   r0, r1
+#       bhs   done
+#       adr   r6, sector_map        ; find the size of the sector at r0
+#   find:
+#       ldr   r3, [r6, #8]
+#       cmp   r0, r3
+#       blo   found
+#       adds  r6, #8
+#       b     find
+#   found:
+#       ldr   r3, [r6, #4]
+#       adds  r3, r0, r3
+#       movs  r4, #0
+#       mvns  r4, r4
+#       adr   r5, crc_nibbles
+#   byte:
+#       ldrb  r6, [r0]
+#       adds  r0, #1
+#       eors  r4, r6
+#       movs  r6, #15               ; low nibble
+#       ands  r6, r4
+#       lsls  r6, r6, #2
+#       ldr   r6, [r5, r6]
+#       lsrs  r4, r4, #4
+#       eors  r4, r6
+#       movs  r6, #15               ; high nibble
+#       ands  r6, r4
+#       lsls  r6, r6, #2
+#       ldr   r6, [r5, r6]
+#       lsrs  r4, r4, #4
+#       eors  r4, r6
+#       cmp   r0, r3
+#       blo   byte
+#       mvns  r4, r4
+#       stmia r2!, {r4}
+#       b     sector
+#   done:
+#       pop   {r3}                  ; crc_table, return the CRC count
+#       subs  r0, r2, r3
+#       lsrs  r0, r0, #2
+#       pop   {r4-r7, pc}
+#       nop
+ANALYZER_CODE = (
+    0x1841b5f4, 0x42994b24, 0x4619d900, 0xd21e4288, 0x68b3a622, 0xd3014298,
+    0xe7fa3608, 0x18c36873, 0x43e42400, 0x7806a50c, 0x40743001, 0x4026260f,
+    0x59ae00b6, 0x40740924, 0x4026260f, 0x59ae00b6, 0x40740924, 0xd3ee4298,
+    0xc21043e4, 0xbc08e7de, 0x08801ad0, 0x46c0bdf0,
+)
+ANALYZER_CRC_NIBBLES = (
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+)
+
 def str_to_num(val):
     return int(val,0)  #convert string to number and automatically handle hex conversion
 
+def append_analyzer(algo):
+    """Append the sector CRC analyzer to the algo, return its entry and sector map offsets"""
+    flash_end = algo.flash_start + algo.flash_size
+    sector_map = []
+    for start, size in algo.sector_sizes:
+        sector_map += [algo.flash_start + start, size]
+    sector_map += [flash_end, 0]
+
+    words = ANALYZER_CODE + ANALYZER_CRC_NIBBLES + (flash_end,) + tuple(sector_map)
+    pad_size = 0 if len(algo.algo_data) % 4 == 0 else 4 - len(algo.algo_data) % 4
+    algo.algo_data += bytearray(pad_size)
+    entry = len(algo.algo_data)
+    algo.algo_data += bytearray(struct.pack("<" + "L" * len(words), *words))
+    return entry, entry + 4 * (len(ANALYZER_CODE) + len(ANALYZER_CRC_NIBBLES) + 1)
+
+def stack_pointer(algo, blob_start):
+    """Return the initial stack pointer of an algo loaded at blob_start"""
+    # Allocate stack after algo, its rw/zi data and the analyzer, rounded up.
+    # The analyzer CRC table starts at the top of the stack.
+    SP = blob_start + HEADER_SIZE + len(algo.algo_data) + STACK_SIZE
+    return (SP + 0x100 - 1) // 0x100 * 0x100
+
+def crc_table_len(algo):
+    """Return the maximum number of CRCs the analyzer can store in one call"""
+    # Bounded by the smallest sector; the host must cap sz so that the table,
+    # which grows up from the stack pointer, stays within its RAM.
+    return algo.flash_size // min(size for _, size in algo.sector_sizes)
+
 def main():
     parser = argparse.ArgumentParser(description="Blob generator")
     parser.add_argument("elf_path", help="Elf, axf, or flm to extract "
                         "flash algo from")
     parser.add_argument("--blob_start", default=0x20000000, type=str_to_num, help="Starting "
                         "address of the flash blob. Used only for DAPLink.")
+    parser.add_argument("--profile", default=None, help="Build profile of the elf "
+                        "(debug, size or speed), recorded in the blobs. Default is "
+                        "the profile of a make_gcc_arm build, otherwise debug.")
     args = parser.parse_args()
 
     with open(args.elf_path, "rb") as file_handle:
@@ -51,9 +154,8 @@ def main():
     template_dir = os.path.dirname(os.path.realpath(__file__))
     output_dir = os.path.dirname(args.elf_path)
 
-    # Allocate stack after algo and its rw data, rounded up.
-    SP = args.blob_start + HEADER_SIZE + algo.rw_start + algo.rw_size + STACK_SIZE
-    SP = (SP + 0x100 - 1) // 0x100 * 0x100
+    analyzer, sector_map = append_analyzer(algo)
+    SP = stack_pointer(algo, args.blob_start)
 
     data_dict = {
         'name': os.path.splitext(os.path.split(args.elf_path)[-1])[0],
@@ -61,6 +163,10 @@ def main():
         'header_size': HEADER_SIZE,
         'entry': args.blob_start,
         'stack_pointer': SP,
+        'profile': args.profile or algo.profile or "debug",
+        'analyzer': analyzer,
+        'sector_map': sector_map,
+        'crc_table_len': crc_table_len(algo),
     }
 
     tmpl_name_list = [
@@ -0,0 +1,145 @@
+#!/usr/bin/env python
+"""
+ mbed
+ Copyright (c) 2017-2017 ARM Limited
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+
+This script compares builds of the same algorithm made with different
+make_gcc_arm profiles (debug, size, speed). It reports the blob and RAM size
+of each build and, when a FlashStats read back of a FLASH_STATS build is
+given, the cycles spent per call. The fastest build that fits the RAM
+budget is recommended. Cycle counts are only compared between builds timed
+with the same counter.
+"""
+
+from __future__ import print_function
+import json
+import argparse
+
+from flash_algo import PackFlashAlgo
+from generate_blobs import HEADER_SIZE, append_analyzer, stack_pointer
+
+TIMED = ("EraseSector", "ProgramPage")
+
+
+def str_to_num(val):
+    return int(val, 0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Build profile report")
+    parser.add_argument("--build", nargs="+", action="append", required=True,
+                        metavar="PROFILE ELF [STATS]",
+                        help="Profile name, algo elf and optionally the json "
+                        "of PackFlashAlgo.parse_flash_stats() for that build")
+    parser.add_argument("--ram_size", type=str_to_num, default=None,
+                        help="RAM available for the blob, stack and buffers")
+    parser.add_argument("--json", action="store_true",
+                        help="Print the report as json")
+    args = parser.parse_args()
+
+    builds = []
+    for build in args.build:
+        if len(build) not in (2, 3):
+            parser.error("--build takes PROFILE ELF [STATS]")
+        stats = None
+        if len(build) == 3:
+            with open(build[2]) as file_handle:
+                stats = json.load(file_handle)
+        with open(build[1], "rb") as file_handle:
+            algo = PackFlashAlgo(file_handle.read())
+        builds.append(profile_summary(build[0], algo, stats))
+
+    best = recommend(builds, args.ram_size)
+    if args.json:
+        print(json.dumps({"builds": builds, "recommended": best},
+                         indent=2, sort_keys=True))
+    else:
+        print(format_report(builds, best))
+
+
+def profile_summary(profile, algo, stats=None):
+    """
+    Sizes and cycle counts of one build
+
+    :param profile: profile name
+    :param algo: PackFlashAlgo of the build
+    :param stats: parse_flash_stats() result or None
+    """
+    append_analyzer(algo)
+    summary = {
+        "profile": profile,
+        "code": algo.ro_size,
+        "data": algo.rw_size + algo.zi_size,
+        "blob": HEADER_SIZE + len(algo.algo_data),
+        # Blob and stack, the page buffer is placed by the host
+        "ram": stack_pointer(algo, 0) + algo.page_size,
+        "counter": stats["counter"] if stats is not None else None,
+    }
+    for name in TIMED:
+        if stats is None or stats[name]["calls"] == 0:
+            summary[name] = None
+            continue
+        entry = stats[name]
+        summary[name] = {
+            "cycles": entry["cycles"] // entry["calls"],
+            "busy": entry["busy"] * 100 // max(entry["cycles"], 1),
+        }
+    return summary
+
+
+def recommend(builds, ram_size=None):
+    """Name of the fastest build that fits, by ProgramPage then EraseSector cycles"""
+    counters = set(build["counter"] for build in builds
+                   if build["counter"] is not None)
+    if len(counters) > 1:
+        raise Exception("Builds timed with different counters (%s), "
+                        "cycles are not comparable" %
+                        ", ".join(sorted(counters)))
+    fits = [build for build in builds
+            if ram_size is None or build["ram"] <= ram_size]
+    if not fits:
+        return None
+
+    def cost(build):
+        cycles = [build[name]["cycles"] if build[name] else float("inf")
+                  for name in TIMED[::-1]]
+        return cycles + [build["ram"]]
+    return min(fits, key=cost)["profile"]
+
+
+def format_report(builds, best):
+    lines = ["%-10s %8s %8s %8s %8s %8s %22s %22s" %
+             ("profile", "code", "data", "blob", "ram", "counter",
+              "EraseSector cyc/busy", "ProgramPage cyc/busy")]
+    for build in builds:
+        timed = []
+        for name in TIMED:
+            if build[name] is None:
+                timed.append("-")
+            else:
+                timed.append("%d/%d%%" % (build[name]["cycles"],
+                                          build[name]["busy"]))
+        lines.append("%-10s %8d %8d %8d %8d %8s %22s %22s" %
+                     (build["profile"], build["code"], build["data"],
+                      build["blob"], build["ram"], build["counter"] or "-",
+                      timed[0], timed[1]))
+    lines.append("")
+    lines.append("recommended: %s" % (best or "none fits"))
+    return "\n".join(lines)
+
+
+if __name__ == '__main__':
+    main()
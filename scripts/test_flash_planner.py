@@ -0,0 +1,102 @@
+#!/usr/bin/env python
+"""
+ mbed
+ Copyright (c) 2017-2017 ARM Limited
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+
+Smoke test of FlashPlanner.plan on a synthetic flash layout, run with
+python -m unittest test_flash_planner from the scripts directory.
+"""
+
+import unittest
+
+from flash_planner import FlashPlanner, sector_crc
+
+
+class FakeFlashInfo(object):
+    """Flash description with eight 4KB sectors followed by two 16KB sectors"""
+    start = 0x0
+    size = 0x10000
+    page_size = 0x100
+    value_empty = 0xFF
+    prog_timeout_ms = 1
+    erase_timeout_ms = 50
+    sector_info_list = [(0x0, 0x1000), (0x8000, 0x4000)]
+
+
+def _ops(plan, op):
+    return [(int(item["address"], 0), int(item["size"], 0))
+            for item in plan["operations"] if item["op"] == op]
+
+
+class FlashPlannerTest(unittest.TestCase):
+
+    def setUp(self):
+        self.planner = FlashPlanner(FakeFlashInfo())
+
+    def test_sectors(self):
+        self.assertEqual(len(self.planner.sectors), 10)
+        self.assertEqual(self.planner.sectors[8], (0x8000, 0x4000))
+
+    def test_sector_erase(self):
+        # Two pages in the first sector, the second partly written, and a
+        # blank page between two written ones in the first 16KB sector
+        data = bytearray([0xFF]) * 0x300
+        data[0:0x100] = bytearray([0x55]) * 0x100
+        data[0x200:0x300] = bytearray([0xAA]) * 0x100
+        segments = [(0x0, bytearray(range(0x80)) * 3), (0x8000, data)]
+        plan = self.planner.plan(segments, "sector")
+
+        self.assertEqual(plan["erase"], "sector")
+        self.assertEqual(_ops(plan, "erase_sectors"),
+                         [(0x0, 0x1000), (0x8000, 0x4000)])
+        self.assertEqual(_ops(plan, "program_page"),
+                         [(0x0, 0x100), (0x100, 0x100),
+                          (0x8000, 0x100), (0x8200, 0x100)])
+        self.assertEqual(plan["skipped_sectors"], 0)
+
+    def test_previous_crcs(self):
+        segments = [(0x0, bytearray([0x11]) * 0x2000)]
+        first = self.planner.plan(segments, "sector")
+        previous = dict((int(address, 0), crc)
+                        for address, crc in first["sector_crcs"].items())
+
+        segments[0][1][0x1000] = 0x22
+        plan = self.planner.plan(segments, "sector", previous)
+        self.assertEqual(plan["skipped_sectors"], 1)
+        self.assertEqual(_ops(plan, "erase_sectors"), [(0x1000, 0x1000)])
+        self.assertEqual(plan["sector_crcs"]["0x0"],
+                         sector_crc(bytearray([0x11]) * 0x1000))
+
+    def test_auto_chip_erase(self):
+        planner = FlashPlanner(FakeFlashInfo(), {"erase_chip_ms": 10})
+        plan = planner.plan([(0x0, bytearray([0x33]) * 0x10000)])
+        self.assertEqual(plan["erase"], "chip")
+        self.assertEqual(plan["operations"][0], {"op": "erase_chip"})
+        self.assertEqual(len(_ops(plan, "program_page")), 0x100)
+
+    def test_banks(self):
+        planner = FlashPlanner(FakeFlashInfo(), banks=[0x8000])
+        segments = [(0x0, bytearray([0x44]) * 0x1000),
+                    (0x8000, bytearray([0x44]) * 0x100)]
+        plan = planner.plan(segments, "sector")
+        self.assertEqual([item["bank"] for item in plan["operations"]
+                          if item["op"] == "erase_sectors"], [0, 1])
+        self.assertEqual(_ops(plan, "program_page")[:2],
+                         [(0x0, 0x100), (0x8000, 0x100)])
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -71,4 +71,6 @@ struct FlashDevice {
   }
 #endif
 
+#include "FlashStats.h"
+
 #endif
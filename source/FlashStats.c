@@ -0,0 +1,175 @@
+/* Flash OS Routines
+ * Copyright (c) 2009-2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file FlashStats.c */
+
+#define FLASH_STATS_IMPL
+#include "FlashStats.h"
+#include "FlashPrg.h"
+
+#ifdef FLASH_STATS
+
+/*
+ * Cycle counter instrumentation of the algo entry points, built with FLASH_STATS.
+ * The counter is picked on the target: cores without a DWT cycle counter
+ * (ARMv6-M, ARMv8-M Baseline, or NOCYCCNT set) use SysTick instead.
+ */
+#define CPUID           (*((volatile uint32_t *)0xE000ED00))
+#define CPUID_ARCH_BASELINE 0xC         // CPUID.ARCHITECTURE of ARMv6-M and ARMv8-M Baseline
+#define DEMCR           (*((volatile uint32_t *)0xE000EDFC))
+#define DEMCR_TRCENA    (1 << 24)
+#define DWT_CTRL        (*((volatile uint32_t *)0xE0001000))
+#define DWT_CTRL_CYCCNTENA  (1 << 0)
+#define DWT_CTRL_NOCYCCNT   (1 << 25)
+#define DWT_CYCCNT      (*((volatile uint32_t *)0xE0001004))
+#define SYST_CSR        (*((volatile uint32_t *)0xE000E010))
+#define SYST_CSR_ENABLE_CORE    0x5     // enabled, processor clock, no interrupt
+#define SYST_RVR        (*((volatile uint32_t *)0xE000E014))
+#define SYST_CVR        (*((volatile uint32_t *)0xE000E018))
+
+struct FlashStats FlashStats;
+
+static uint32_t counter;
+static uint32_t counterMask;    // 0 until the counter is detected
+static uint32_t current;
+static uint32_t busyStart;
+
+static void CounterDetect(void)
+{
+    counter = FLASH_STATS_SYSTICK;
+    counterMask = 0x00FFFFFF;
+    // The DWT is only accessed on Mainline cores, with trace enabled
+    if (((CPUID >> 16) & 0xF) != CPUID_ARCH_BASELINE) {
+        DEMCR |= DEMCR_TRCENA;
+        if (!(DWT_CTRL & DWT_CTRL_NOCYCCNT)) {
+            counter = FLASH_STATS_DWT;
+            counterMask = 0xFFFFFFFF;
+        }
+    }
+}
+
+static void CounterStart(void)
+{
+    if (counterMask == 0) {
+        CounterDetect();
+    }
+    if (counter == FLASH_STATS_DWT) {
+        if (!(DEMCR & DEMCR_TRCENA) || !(DWT_CTRL & DWT_CTRL_CYCCNTENA)) {
+            DEMCR |= DEMCR_TRCENA;
+            DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+        }
+    } else {
+        if ((SYST_CSR & SYST_CSR_ENABLE_CORE) != SYST_CSR_ENABLE_CORE || SYST_RVR != counterMask) {
+            SYST_RVR = counterMask;
+            SYST_CVR = 0;
+            SYST_CSR = SYST_CSR_ENABLE_CORE;
+        }
+    }
+    FlashStats.version = FLASH_STATS_VERSION;
+    FlashStats.counter = counter;
+}
+
+static uint32_t CounterRead(void)
+{
+    if (counter == FLASH_STATS_DWT) {
+        return DWT_CYCCNT;
+    }
+    // SysTick counts down
+    return counterMask - SYST_CVR;
+}
+
+static uint32_t Enter(uint32_t index)
+{
+    current = index;
+    FlashStats.entry[index].calls++;
+    return CounterRead();
+}
+
+static void Exit(uint32_t start)
+{
+    struct FlashStatsEntry *entry = &FlashStats.entry[current];
+    uint32_t cycles = (CounterRead() - start) & counterMask;
+
+    entry->cycles += cycles;
+    if (cycles > entry->max) {
+        entry->max = cycles;
+    }
+}
+
+/* FlashStats.h interface */
+
+void FlashStats_BusyBegin(void)
+{
+    busyStart = CounterRead();
+}
+
+void FlashStats_BusyEnd(void)
+{
+    FlashStats.entry[current].busy += (CounterRead() - busyStart) & counterMask;
+}
+
+/* FlashPrg.h interface, timed calls into the driver */
+
+uint32_t Init(uint32_t adr, uint32_t clk, uint32_t fnc)
+{
+    uint32_t start, ret;
+
+    CounterStart();
+    start = Enter(FLASH_STATS_INIT);
+    ret = FlashStats_Init(adr, clk, fnc);
+    Exit(start);
+    // Some drivers stop SysTick in Init
+    CounterStart();
+    return ret;
+}
+
+uint32_t UnInit(uint32_t fnc)
+{
+    uint32_t start = Enter(FLASH_STATS_UNINIT);
+    uint32_t ret = FlashStats_UnInit(fnc);
+
+    Exit(start);
+    return ret;
+}
+
+uint32_t EraseChip(void)
+{
+    uint32_t start = Enter(FLASH_STATS_ERASECHIP);
+    uint32_t ret = FlashStats_EraseChip();
+
+    Exit(start);
+    return ret;
+}
+
+uint32_t EraseSector(uint32_t adr)
+{
+    uint32_t start = Enter(FLASH_STATS_ERASESECTOR);
+    uint32_t ret = FlashStats_EraseSector(adr);
+
+    Exit(start);
+    return ret;
+}
+
+uint32_t ProgramPage(uint32_t adr, uint32_t sz, uint32_t *buf)
+{
+    uint32_t start = Enter(FLASH_STATS_PROGRAMPAGE);
+    uint32_t ret = FlashStats_ProgramPage(adr, sz, buf);
+
+    Exit(start);
+    return ret;
+}
+
+#endif
@@ -0,0 +1,107 @@
+/* Flash OS Routines
+ * Copyright (c) 2009-2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file FlashStats.h */
+
+#ifndef FLASHSTATS_H
+#define FLASHSTATS_H
+
+#include "stdint.h"
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
+#define FLASH_STATS_VERSION     1
+
+// FlashStats.entry[] index of each timed function. BlankCheck and Verify are
+// optional and not timed: a wrapper would export them for drivers which don't
+// implement them, and DAPLink and pyOCD never call them.
+#define FLASH_STATS_INIT        0
+#define FLASH_STATS_UNINIT      1
+#define FLASH_STATS_ERASECHIP   2
+#define FLASH_STATS_ERASESECTOR 3
+#define FLASH_STATS_PROGRAMPAGE 4
+#define FLASH_STATS_ENTRIES     5
+
+// FlashStats.counter
+#define FLASH_STATS_DWT         0       // DWT->CYCCNT, 32 bits
+#define FLASH_STATS_SYSTICK     1       // SysTick, 24 bits, longer calls wrap
+
+/**
+    @struct FlashStatsEntry
+    @brief  Cycles spent in one of the timed functions
+ */
+struct FlashStatsEntry {
+    uint32_t calls;         /*!< Number of calls */
+    uint32_t cycles;        /*!< Total cycles, entry to exit */
+    uint32_t max;           /*!< Longest call in cycles */
+    uint32_t busy;          /*!< Total cycles spent waiting on the flash controller */
+};
+
+/**
+    @struct FlashStats
+    @brief  Cycle counts of a programming session, read back by the host
+ */
+struct FlashStats {
+    uint32_t version;       /*!< FLASH_STATS_VERSION */
+    uint32_t counter;       /*!< FLASH_STATS_DWT or FLASH_STATS_SYSTICK */
+    struct FlashStatsEntry entry[FLASH_STATS_ENTRIES];
+};
+
+#ifdef FLASH_STATS
+
+// Lives in PrgData so it is cleared when the algo is loaded and accumulates over the session
+extern struct FlashStats FlashStats;
+
+void FlashStats_BusyBegin(void);
+void FlashStats_BusyEnd(void);
+
+// Wrap a controller busy-wait
+#define FLASH_STATS_BUSY_BEGIN()    FlashStats_BusyBegin()
+#define FLASH_STATS_BUSY_END()      FlashStats_BusyEnd()
+
+#ifndef FLASH_STATS_IMPL
+// The driver functions are renamed, FlashStats.c exports the timed entry points
+#define Init                        FlashStats_Init
+#define UnInit                      FlashStats_UnInit
+#define EraseChip                   FlashStats_EraseChip
+#define EraseSector                 FlashStats_EraseSector
+#define ProgramPage                 FlashStats_ProgramPage
+#endif
+
+// The renamed driver functions, called by FlashStats.c. Drivers built with
+// FLASH_STATS must define them with the FlashPrg.h signatures, drivers with the
+// FlashOS int/unsigned long signatures fail to compile instead of mismatching
+// the wrappers at link time.
+uint32_t FlashStats_Init(uint32_t adr, uint32_t clk, uint32_t fnc);
+uint32_t FlashStats_UnInit(uint32_t fnc);
+uint32_t FlashStats_EraseChip(void);
+uint32_t FlashStats_EraseSector(uint32_t adr);
+uint32_t FlashStats_ProgramPage(uint32_t adr, uint32_t sz, uint32_t *buf);
+
+#else
+
+#define FLASH_STATS_BUSY_BEGIN()
+#define FLASH_STATS_BUSY_END()
+
+#endif
+
+#ifdef __cplusplus
+  }
+#endif
+
+#endif
@@ -15,21 +15,36 @@
  */
 
 #include "FlashOS.H"        // FlashOS Structures
+#include "fsl_device_registers.h"
 
 #define FLASH_DRV_VERS (0x0100+VERS)   // Driver Version, do not modify!
-#define DEVICE_NAME    "MKXX"
+
+#ifdef FLASH_ALGO_DFLASH
+// FlexNVM window of the part selected by the CPU_ macro of the target,
+// the part of it partitioned as D-Flash is read from the IFR at Init
+#define DEVICE_NAME         "MKXX D-Flash"
+#define FLASH_START         (FSL_FEATURE_FLASH_FLEX_NVM_START_ADDRESS)
+#define FLASH_SIZE          (FSL_FEATURE_FLASH_FLEX_NVM_BLOCK_COUNT * FSL_FEATURE_FLASH_FLEX_NVM_BLOCK_SIZE)
+#define FLASH_SECTOR_SIZE   (FSL_FEATURE_FLASH_FLEX_NVM_BLOCK_SECTOR_SIZE)
+#else
+// P-Flash geometry of the part selected by the CPU_ macro of the target
+#define DEVICE_NAME         "MKXX"
+#define FLASH_START         (FSL_FEATURE_FLASH_PFLASH_START_ADDRESS)
+#define FLASH_SIZE          (FSL_FEATURE_FLASH_PFLASH_BLOCK_COUNT * FSL_FEATURE_FLASH_PFLASH_BLOCK_SIZE)
+#define FLASH_SECTOR_SIZE   (FSL_FEATURE_FLASH_PFLASH_BLOCK_SECTOR_SIZE)
+#endif
 
 struct FlashDevice const FlashDevice = {
     FLASH_DRV_VERS,             // Driver Version, do not modify!
     DEVICE_NAME,                // Device Name
     ONCHIP,                     // Device Type
-    0x00000000,                 // Device Start Address
-    0x00000000,                 // Device Size
-    1024,                       // Programming Page Size
+    FLASH_START,                // Device Start Address
+    FLASH_SIZE,                 // Device Size
+    FLASH_SECTOR_SIZE,          // Programming Page Size, one sector per call
     0,                          // Reserved, must be 0
     0xFF,                       // Initial Content of Erased Memory
-    100,                        // Program Page Timeout 100 mSec
+    500,                        // Program Page Timeout 500 mSec
     3000,                       // Erase Sector Timeout 3000 mSec
-    {{0x000400, 0x000000},      // Sector Size  1kB
+    {{FLASH_SECTOR_SIZE, 0x000000},     // Sector Size  1kB to 8kB, per part
     {SECTOR_END}}
 };
@@ -21,6 +21,20 @@
 //! Pre-shifted value of RUNM field when set to VLPR mode.
 #define SMC_PMCTRL_RUNM_VLPR (SMC_PMCTRL_RUNM(0x02))
 
+#ifdef FLASH_ALGO_DFLASH
+//! D-Flash sector size, the partitioned D-Flash range is read from the IFR by FLASH_Init.
+#define SECTOR_SIZE (FSL_FEATURE_FLASH_FLEX_NVM_BLOCK_SECTOR_SIZE)
+//! Size of the FlexNVM blocks, all of it is D-Flash when no EEPROM backup is partitioned.
+#define FLEXNVM_SIZE (FSL_FEATURE_FLASH_FLEX_NVM_BLOCK_COUNT * FSL_FEATURE_FLASH_FLEX_NVM_BLOCK_SIZE)
+//! Program Section command, programs a whole page through the FlexRAM.
+#if defined(FSL_FEATURE_FLASH_HAS_PROGRAM_SECTION_CMD) && FSL_FEATURE_FLASH_HAS_PROGRAM_SECTION_CMD && \
+    FSL_FEATURE_FLASH_FLEX_NVM_SECTION_CMD_ADDRESS_ALIGMENT
+#define SECTION_ALIGN (FSL_FEATURE_FLASH_FLEX_NVM_SECTION_CMD_ADDRESS_ALIGMENT)
+#endif
+#else
+#define SECTOR_SIZE (g_flash.PFlashSectorSize)
+#endif
+
 flash_config_t g_flash; //!< Storage for flash driver.
 bool g_wasInVlpr; //!< Saved VLPR mode flag.
 
@@ -66,7 +80,20 @@ uint32_t Init(uint32_t adr, uint32_t clk, uint32_t fnc)
     }
 #endif // FSL_FEATURE_SOC_SMC_COUNT
 
-    return (FLASH_Init(&g_flash) != kStatus_Success);
+    if (FLASH_Init(&g_flash) != kStatus_Success)
+    {
+        return (1);
+    }
+
+#ifdef FLASH_ALGO_DFLASH
+    // FLASH_Init read the FlexNVM partition from the IFR, fail on unpartitioned parts.
+    if ((g_flash.DFlashTotalSize == 0) || (g_flash.DFlashTotalSize == 0xFFFFFFFFU))
+    {
+        return (1);
+    }
+#endif
+
+    return (0);
 }
 
 
@@ -78,6 +105,9 @@ uint32_t Init(uint32_t adr, uint32_t clk, uint32_t fnc)
 
 uint32_t UnInit(uint32_t fnc)
 {
+    // Erase and program leave the flash cache stale, clear it once for the whole batch
+    FLASH_CacheClear(&g_flash);
+
 #if FSL_FEATURE_SOC_SMC_COUNT > 0
     // Restore VLPR mode if it was enabled when we inited.
     if (g_wasInVlpr)
@@ -139,11 +169,33 @@ uint32_t UnInit(uint32_t fnc)
  */
 uint32_t EraseChip(void)
 {
+#ifdef FLASH_ALGO_DFLASH
+    // Only the D-Flash is erased, with one command per block unless part of
+    // the FlexNVM backs the EEPROM.
+    int status = kStatus_Success;
+    if (g_flash.DFlashTotalSize == FLEXNVM_SIZE)
+    {
+        for (uint32_t i = 0; (i < FSL_FEATURE_FLASH_FLEX_NVM_BLOCK_COUNT) && (status == kStatus_Success); i++)
+        {
+            status = FLASH_EraseBlock(&g_flash, g_flash.DFlashBlockBase + i * FSL_FEATURE_FLASH_FLEX_NVM_BLOCK_SIZE,
+                                      kFLASH_apiEraseKey);
+        }
+    }
+    else
+    {
+        status = FLASH_Erase(&g_flash, g_flash.DFlashBlockBase, g_flash.DFlashTotalSize, kFLASH_apiEraseKey);
+    }
+    if (status == kStatus_Success)
+    {
+        status = FLASH_VerifyErase(&g_flash, g_flash.DFlashBlockBase, g_flash.DFlashTotalSize, kFLASH_marginValueNormal);
+    }
+#else
     int status = FLASH_EraseAll(&g_flash, kFLASH_apiEraseKey);
     if (status == kStatus_Success)
     {
         status = FLASH_VerifyEraseAll(&g_flash, kFLASH_marginValueNormal);
     }
+#endif
     return status;
 }
 
@@ -155,10 +207,10 @@ uint32_t EraseChip(void)
  */
 uint32_t EraseSector(uint32_t adr)
 {
-    int status = FLASH_Erase(&g_flash, adr, g_flash.PFlashSectorSize, kFLASH_apiEraseKey);
+    int status = FLASH_Erase(&g_flash, adr, SECTOR_SIZE, kFLASH_apiEraseKey);
     if (status == kStatus_Success)
     {
-        status = FLASH_VerifyErase(&g_flash, adr, g_flash.PFlashSectorSize, kFLASH_marginValueNormal);
+        status = FLASH_VerifyErase(&g_flash, adr, SECTOR_SIZE, kFLASH_marginValueNormal);
     }
     return status;
 }
@@ -172,7 +224,13 @@ uint32_t EraseSector(uint32_t adr)
  */
 uint32_t ProgramPage(uint32_t adr, uint32_t sz, uint32_t *buf)
 {
+#ifdef SECTION_ALIGN
+    // Whole pages are staged in the FlexRAM and programmed with one command
+    int status = ((sz % SECTION_ALIGN) == 0) ? FLASH_ProgramSection(&g_flash, adr, buf, sz)
+                                             : FLASH_Program(&g_flash, adr, buf, sz);
+#else
     int status = FLASH_Program(&g_flash, adr, buf, sz);
+#endif
     if (status == kStatus_Success)
     {
         // Must use kFlashMargin_User, or kFlashMargin_Factory for verify program
@@ -29,6 +29,7 @@
  */
 
 #include "fsl_flash.h"
+#include "FlashStats.h"
 
 /*******************************************************************************
  * Definitions
@@ -251,6 +252,9 @@ static status_t flash_command_sequence(flash_config_t *config);
 /*! @brief Perform the cache clear to the flash*/
 void flash_cache_clear(flash_config_t *config);
 
+/*! @brief Clear the flash cache after a command, or mark it stale when the clear is deferred*/
+static void flash_cache_clear_after_command(flash_config_t *config);
+
 /*! @brief Validates the range and alignment of the given address range.*/
 static status_t flash_check_range(flash_config_t *config,
                                   uint32_t startAddress,
@@ -263,18 +267,18 @@ static status_t flash_get_matched_operation_info(flash_config_t *config,
 /*! @brief Validates the given user key for flash erase APIs.*/
 static status_t flash_check_user_key(uint32_t key);
 
-// #if FLASH_SSD_IS_FLEXNVM_ENABLED
-// /*! @brief Updates FlexNVM memory partition status according to data flash 0 IFR.*/
-// static status_t flash_update_flexnvm_memory_partition_status(flash_config_t *config);
-// #endif /* FLASH_SSD_IS_FLEXNVM_ENABLED */
+#if FLASH_SSD_IS_FLEXNVM_ENABLED
+/*! @brief Updates FlexNVM memory partition status according to data flash 0 IFR.*/
+static status_t flash_update_flexnvm_memory_partition_status(flash_config_t *config);
+#endif /* FLASH_SSD_IS_FLEXNVM_ENABLED */
 
-// #if defined(FSL_FEATURE_FLASH_HAS_READ_RESOURCE_CMD) && FSL_FEATURE_FLASH_HAS_READ_RESOURCE_CMD
-// /*! @brief Validates the range of the given resource address.*/
-// static status_t flash_check_resource_range(uint32_t start,
-//                                            uint32_t lengthInBytes,
-//                                            uint32_t alignmentBaseline,
-//                                            flash_read_resource_option_t option);
-// #endif /* FSL_FEATURE_FLASH_HAS_READ_RESOURCE_CMD */
+#if FLASH_SSD_IS_FLEXNVM_ENABLED && defined(FSL_FEATURE_FLASH_HAS_READ_RESOURCE_CMD) && FSL_FEATURE_FLASH_HAS_READ_RESOURCE_CMD
+/*! @brief Validates the range of the given resource address.*/
+static status_t flash_check_resource_range(uint32_t start,
+                                           uint32_t lengthInBytes,
+                                           uint32_t alignmentBaseline,
+                                           flash_read_resource_option_t option);
+#endif /* FSL_FEATURE_FLASH_HAS_READ_RESOURCE_CMD */
 //
 // #if defined(FSL_FEATURE_FLASH_HAS_SWAP_CONTROL_CMD) && FSL_FEATURE_FLASH_HAS_SWAP_CONTROL_CMD
 // /*! @brief Validates the gived swap control option.*/
@@ -286,10 +290,10 @@ static status_t flash_check_user_key(uint32_t key);
 // static status_t flash_validate_swap_indicator_address(flash_config_t *config, uint32_t address);
 // #endif /* FSL_FEATURE_FLASH_HAS_PFLASH_BLOCK_SWAP */
 //
-// #if defined(FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD) && FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD
-// /*! @brief Validates the gived flexram function option.*/
-// static inline status_t flasn_check_flexram_function_option_range(flash_flexram_function_option_t option);
-// #endif /* FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD */
+#if FLASH_SSD_IS_FLEXNVM_ENABLED && defined(FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD) && FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD
+/*! @brief Validates the gived flexram function option.*/
+static inline status_t flasn_check_flexram_function_option_range(flash_flexram_function_option_t option);
+#endif /* FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD */
 
 /*******************************************************************************
  * Variables
@@ -333,6 +337,11 @@ static uint8_t s_flashCacheClearCommand[kFLASH_executeInRamFunctionMaxSize];
 static flash_execute_in_ram_function_config_t s_flashExecuteInRamFunctionInfo;
 #endif
 
+#if FLASH_DRIVER_DEFER_CACHE_CLEAR
+/*! @brief Set when erase or program left the flash cache stale */
+static bool s_flashCacheClearPending;
+#endif
+
 /*!
  * @brief Table of pflash sizes.
  *
@@ -496,7 +505,7 @@ status_t FLASH_EraseAll(flash_config_t *config, uint32_t key)
     /* calling flash command sequence function to execute the command */
     returnCode = flash_command_sequence(config);
 
-    flash_cache_clear(config);
+    flash_cache_clear_after_command(config);
 
 #if FLASH_SSD_IS_FLEXNVM_ENABLED
     /* Data flash IFR will be erased by erase all command, so we need to
@@ -576,10 +585,57 @@ status_t FLASH_Erase(flash_config_t *config, uint32_t start, uint32_t lengthInBy
         }
     }
 
-    flash_cache_clear(config);
+    flash_cache_clear_after_command(config);
+
+    return (returnCode);
+}
+
+#if FLASH_SSD_IS_FLEXNVM_ENABLED
+status_t FLASH_EraseBlock(flash_config_t *config, uint32_t start, uint32_t key)
+{
+    flash_operation_config_t flashInfo;
+    uint32_t blockStart;
+    status_t returnCode;
+
+    if ((config == NULL) || (start < config->DFlashBlockBase))
+    {
+        return kStatus_FLASH_InvalidArgument;
+    }
+
+    flash_get_matched_operation_info(config, start, &flashInfo);
+
+    /* Check the supplied address range, the whole block has to be D-Flash. */
+    blockStart = start - (start - config->DFlashBlockBase) % flashInfo.activeBlockSize;
+    returnCode = flash_check_range(config, blockStart, flashInfo.activeBlockSize, flashInfo.sectorCmdAddressAligment);
+    if (returnCode)
+    {
+        return returnCode;
+    }
+
+    /* preparing passing parameter to erase a flash block */
+    kFCCOBx[0] = BYTES_JOIN_TO_WORD_1_3(FTFx_ERASE_BLOCK, blockStart - config->DFlashBlockBase + 0x800000U);
+
+    /* Validate the user key */
+    returnCode = flash_check_user_key(key);
+    if (returnCode)
+    {
+        return returnCode;
+    }
+
+    /* calling flash command sequence function to execute the command */
+    returnCode = flash_command_sequence(config);
+
+    /* calling flash callback function if it is available */
+    if (config->PFlashCallback)
+    {
+        config->PFlashCallback();
+    }
+
+    flash_cache_clear_after_command(config);
 
     return (returnCode);
 }
+#endif /* FLASH_SSD_IS_FLEXNVM_ENABLED */
 
 // #if defined(FSL_FEATURE_FLASH_HAS_ERASE_ALL_BLOCKS_UNSECURE_CMD) && FSL_FEATURE_FLASH_HAS_ERASE_ALL_BLOCKS_UNSECURE_CMD
 // status_t FLASH_EraseAllUnsecure(flash_config_t *config, uint32_t key)
@@ -709,7 +765,7 @@ status_t FLASH_Program(flash_config_t *config, uint32_t start, uint32_t *src, ui
         }
     }
 
-    flash_cache_clear(config);
+    flash_cache_clear_after_command(config);
 
     return (returnCode);
 }
@@ -750,134 +806,134 @@ status_t FLASH_Program(flash_config_t *config, uint32_t start, uint32_t *src, ui
 //     return returnCode;
 // }
 //
-// #if defined(FSL_FEATURE_FLASH_HAS_PROGRAM_SECTION_CMD) && FSL_FEATURE_FLASH_HAS_PROGRAM_SECTION_CMD
-// status_t FLASH_ProgramSection(flash_config_t *config, uint32_t start, uint32_t *src, uint32_t lengthInBytes)
-// {
-//     status_t returnCode;
-//     uint32_t sectorSize;
-//     flash_operation_config_t flashInfo;
-// #if defined(FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD) && FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD
-//     bool needSwitchFlexRamMode = false;
-// #endif /* FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD */
-//
-//     if (src == NULL)
-//     {
-//         return kStatus_FLASH_InvalidArgument;
-//     }
-//
-//     flash_get_matched_operation_info(config, start, &flashInfo);
-//
-//     /* Check the supplied address range. */
-//     returnCode = flash_check_range(config, start, lengthInBytes, flashInfo.sectionCmdAddressAligment);
-//     if (returnCode)
-//     {
-//         return returnCode;
-//     }
-//
-//     start = flashInfo.convertedAddress;
-//     sectorSize = flashInfo.activeSectorSize;
-//
-// #if defined(FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD) && FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD
-//     /* Switch function of FlexRAM if needed */
-//     if (!(FTFx->FCNFG & FTFx_FCNFG_RAMRDY_MASK))
-//     {
-//         needSwitchFlexRamMode = true;
-//
-//         returnCode = FLASH_SetFlexramFunction(config, kFLASH_flexramFunctionOptionAvailableAsRam);
-//         if (returnCode != kStatus_FLASH_Success)
-//         {
-//             return kStatus_FLASH_SetFlexramAsRamError;
-//         }
-//     }
-// #endif /* FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD */
-//
-//     while (lengthInBytes > 0)
-//     {
-//         /* Make sure the write operation doesn't span two sectors */
-//         uint32_t endAddressOfCurrentSector = ALIGN_UP(start, sectorSize);
-//         uint32_t lengthTobeProgrammedOfCurrentSector;
-//         uint32_t currentOffset = 0;
-//
-//         if (endAddressOfCurrentSector == start)
-//         {
-//             endAddressOfCurrentSector += sectorSize;
-//         }
-//
-//         if (lengthInBytes + start > endAddressOfCurrentSector)
-//         {
-//             lengthTobeProgrammedOfCurrentSector = endAddressOfCurrentSector - start;
-//         }
-//         else
-//         {
-//             lengthTobeProgrammedOfCurrentSector = lengthInBytes;
-//         }
-//
-//         /* Program Current Sector */
-//         while (lengthTobeProgrammedOfCurrentSector > 0)
-//         {
-//             /* Make sure the program size doesn't exceeds Acceleration RAM size */
-//             uint32_t programSizeOfCurrentPass;
-//             uint32_t numberOfPhases;
-//
-//             if (lengthTobeProgrammedOfCurrentSector > kFLASH_accelerationRamSize)
-//             {
-//                 programSizeOfCurrentPass = kFLASH_accelerationRamSize;
-//             }
-//             else
-//             {
-//                 programSizeOfCurrentPass = lengthTobeProgrammedOfCurrentSector;
-//             }
-//
-//             /* Copy data to FlexRAM */
-//             memcpy((void *)FSL_FEATURE_FLASH_FLEX_RAM_START_ADDRESS, src + currentOffset / 4, programSizeOfCurrentPass);
-//             /* Set start address of the data to be programmed */
-//             kFCCOBx[0] = BYTES_JOIN_TO_WORD_1_3(FTFx_PROGRAM_SECTION, start + currentOffset);
-//             /* Set program size in terms of FEATURE_FLASH_SECTION_CMD_ADDRESS_ALIGMENT */
-//             numberOfPhases = programSizeOfCurrentPass / flashInfo.sectionCmdAddressAligment;
-//
-//             kFCCOBx[1] = BYTES_JOIN_TO_WORD_2_2(numberOfPhases, 0xFFFFU);
-//
-//             /* Peform command sequence */
-//             returnCode = flash_command_sequence(config);
-//
-//             /* calling flash callback function if it is available */
-//             if (config->PFlashCallback)
-//             {
-//                 config->PFlashCallback();
-//             }
-//
-//             if (returnCode != kStatus_FLASH_Success)
-//             {
-//                 flash_cache_clear(config);
-//                 return returnCode;
-//             }
-//
-//             lengthTobeProgrammedOfCurrentSector -= programSizeOfCurrentPass;
-//             currentOffset += programSizeOfCurrentPass;
-//         }
-//
-//         src += currentOffset / 4;
-//         start += currentOffset;
-//         lengthInBytes -= currentOffset;
-//     }
-//
-//     flash_cache_clear(config);
-//
-// #if defined(FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD) && FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD
-//     /* Restore function of FlexRAM if needed. */
-//     if (needSwitchFlexRamMode)
-//     {
-//         returnCode = FLASH_SetFlexramFunction(config, kFLASH_flexramFunctionOptionAvailableForEeprom);
-//         if (returnCode != kStatus_FLASH_Success)
-//         {
-//             return kStatus_FLASH_RecoverFlexramAsEepromError;
-//         }
-//     }
-// #endif /* FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD */
-//
-//     return returnCode;
-// }
-// #endif /* FSL_FEATURE_FLASH_HAS_PROGRAM_SECTION_CMD */
+#if FLASH_SSD_IS_FLEXNVM_ENABLED && defined(FSL_FEATURE_FLASH_HAS_PROGRAM_SECTION_CMD) && FSL_FEATURE_FLASH_HAS_PROGRAM_SECTION_CMD
+status_t FLASH_ProgramSection(flash_config_t *config, uint32_t start, uint32_t *src, uint32_t lengthInBytes)
+{
+    status_t returnCode;
+    uint32_t sectorSize;
+    flash_operation_config_t flashInfo;
+#if defined(FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD) && FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD
+    bool needSwitchFlexRamMode = false;
+#endif /* FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD */
+
+    if (src == NULL)
+    {
+        return kStatus_FLASH_InvalidArgument;
+    }
+
+    flash_get_matched_operation_info(config, start, &flashInfo);
+
+    /* Check the supplied address range. */
+    returnCode = flash_check_range(config, start, lengthInBytes, flashInfo.sectionCmdAddressAligment);
+    if (returnCode)
+    {
+        return returnCode;
+    }
+
+    start = flashInfo.convertedAddress;
+    sectorSize = flashInfo.activeSectorSize;
+
+#if defined(FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD) && FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD
+    /* Switch function of FlexRAM if needed */
+    if (!(FTFx->FCNFG & FTFx_FCNFG_RAMRDY_MASK))
+    {
+        needSwitchFlexRamMode = true;
+
+        returnCode = FLASH_SetFlexramFunction(config, kFLASH_flexramFunctionOptionAvailableAsRam);
+        if (returnCode != kStatus_FLASH_Success)
+        {
+            return kStatus_FLASH_SetFlexramAsRamError;
+        }
+    }
+#endif /* FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD */
+
+    while (lengthInBytes > 0)
+    {
+        /* Make sure the write operation doesn't span two sectors */
+        uint32_t endAddressOfCurrentSector = ALIGN_UP(start, sectorSize);
+        uint32_t lengthTobeProgrammedOfCurrentSector;
+        uint32_t currentOffset = 0;
+
+        if (endAddressOfCurrentSector == start)
+        {
+            endAddressOfCurrentSector += sectorSize;
+        }
+
+        if (lengthInBytes + start > endAddressOfCurrentSector)
+        {
+            lengthTobeProgrammedOfCurrentSector = endAddressOfCurrentSector - start;
+        }
+        else
+        {
+            lengthTobeProgrammedOfCurrentSector = lengthInBytes;
+        }
+
+        /* Program Current Sector */
+        while (lengthTobeProgrammedOfCurrentSector > 0)
+        {
+            /* Make sure the program size doesn't exceeds Acceleration RAM size */
+            uint32_t programSizeOfCurrentPass;
+            uint32_t numberOfPhases;
+
+            if (lengthTobeProgrammedOfCurrentSector > kFLASH_accelerationRamSize)
+            {
+                programSizeOfCurrentPass = kFLASH_accelerationRamSize;
+            }
+            else
+            {
+                programSizeOfCurrentPass = lengthTobeProgrammedOfCurrentSector;
+            }
+
+            /* Copy data to FlexRAM */
+            memcpy((void *)FSL_FEATURE_FLASH_FLEX_RAM_START_ADDRESS, src + currentOffset / 4, programSizeOfCurrentPass);
+            /* Set start address of the data to be programmed */
+            kFCCOBx[0] = BYTES_JOIN_TO_WORD_1_3(FTFx_PROGRAM_SECTION, start + currentOffset);
+            /* Set program size in terms of FEATURE_FLASH_SECTION_CMD_ADDRESS_ALIGMENT */
+            numberOfPhases = programSizeOfCurrentPass / flashInfo.sectionCmdAddressAligment;
+
+            kFCCOBx[1] = BYTES_JOIN_TO_WORD_2_2(numberOfPhases, 0xFFFFU);
+
+            /* Peform command sequence */
+            returnCode = flash_command_sequence(config);
+
+            /* calling flash callback function if it is available */
+            if (config->PFlashCallback)
+            {
+                config->PFlashCallback();
+            }
+
+            if (returnCode != kStatus_FLASH_Success)
+            {
+                flash_cache_clear_after_command(config);
+                return returnCode;
+            }
+
+            lengthTobeProgrammedOfCurrentSector -= programSizeOfCurrentPass;
+            currentOffset += programSizeOfCurrentPass;
+        }
+
+        src += currentOffset / 4;
+        start += currentOffset;
+        lengthInBytes -= currentOffset;
+    }
+
+    flash_cache_clear_after_command(config);
+
+#if defined(FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD) && FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD
+    /* Restore function of FlexRAM if needed. */
+    if (needSwitchFlexRamMode)
+    {
+        returnCode = FLASH_SetFlexramFunction(config, kFLASH_flexramFunctionOptionAvailableForEeprom);
+        if (returnCode != kStatus_FLASH_Success)
+        {
+            return kStatus_FLASH_RecoverFlexramAsEepromError;
+        }
+    }
+#endif /* FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD */
+
+    return returnCode;
+}
+#endif /* FSL_FEATURE_FLASH_HAS_PROGRAM_SECTION_CMD */
 //
 // #if FLASH_SSD_IS_FLEXNVM_ENABLED
 // status_t FLASH_EepromWrite(flash_config_t *config, uint32_t start, uint8_t *src, uint32_t lengthInBytes)
@@ -961,66 +1017,66 @@ status_t FLASH_Program(flash_config_t *config, uint32_t start, uint32_t *src, ui
 // }
 // #endif /* FLASH_SSD_IS_FLEXNVM_ENABLED */
 //
-// #if defined(FSL_FEATURE_FLASH_HAS_READ_RESOURCE_CMD) && FSL_FEATURE_FLASH_HAS_READ_RESOURCE_CMD
-// status_t FLASH_ReadResource(
-//     flash_config_t *config, uint32_t start, uint32_t *dst, uint32_t lengthInBytes, flash_read_resource_option_t option)
-// {
-//     status_t returnCode;
-//     flash_operation_config_t flashInfo;
-//
-//     if ((config == NULL) || (dst == NULL))
-//     {
-//         return kStatus_FLASH_InvalidArgument;
-//     }
-//
-//     flash_get_matched_operation_info(config, start, &flashInfo);
-//
-//     /* Check the supplied address range. */
-//     returnCode = flash_check_resource_range(start, lengthInBytes, flashInfo.resourceCmdAddressAligment, option);
-//     if (returnCode != kStatus_FLASH_Success)
-//     {
-//         return returnCode;
-//     }
-//
-//     while (lengthInBytes > 0)
-//     {
-//         /* preparing passing parameter */
-//         kFCCOBx[0] = BYTES_JOIN_TO_WORD_1_3(FTFx_READ_RESOURCE, start);
-//         if (flashInfo.resourceCmdAddressAligment == 4)
-//         {
-//             kFCCOBx[2] = BYTES_JOIN_TO_WORD_1_3(option, 0xFFFFFFU);
-//         }
-//         else if (flashInfo.resourceCmdAddressAligment == 8)
-//         {
-//             kFCCOBx[1] = BYTES_JOIN_TO_WORD_1_3(option, 0xFFFFFFU);
-//         }
-//         else
-//         {
-//         }
-//
-//         /* calling flash command sequence function to execute the command */
-//         returnCode = flash_command_sequence(config);
-//
-//         if (kStatus_FLASH_Success != returnCode)
-//         {
-//             break;
-//         }
-//
-//         /* fetch data */
-//         *dst++ = kFCCOBx[1];
-//         if (flashInfo.resourceCmdAddressAligment == 8)
-//         {
-//             *dst++ = kFCCOBx[2];
-//         }
-//         /* update start address for next iteration */
-//         start += flashInfo.resourceCmdAddressAligment;
-//         /* update lengthInBytes for next iteration */
-//         lengthInBytes -= flashInfo.resourceCmdAddressAligment;
-//     }
-//
-//     return (returnCode);
-// }
-// #endif /* FSL_FEATURE_FLASH_HAS_READ_RESOURCE_CMD */
+#if FLASH_SSD_IS_FLEXNVM_ENABLED && defined(FSL_FEATURE_FLASH_HAS_READ_RESOURCE_CMD) && FSL_FEATURE_FLASH_HAS_READ_RESOURCE_CMD
+status_t FLASH_ReadResource(
+    flash_config_t *config, uint32_t start, uint32_t *dst, uint32_t lengthInBytes, flash_read_resource_option_t option)
+{
+    status_t returnCode;
+    flash_operation_config_t flashInfo;
+
+    if ((config == NULL) || (dst == NULL))
+    {
+        return kStatus_FLASH_InvalidArgument;
+    }
+
+    flash_get_matched_operation_info(config, start, &flashInfo);
+
+    /* Check the supplied address range. */
+    returnCode = flash_check_resource_range(start, lengthInBytes, flashInfo.resourceCmdAddressAligment, option);
+    if (returnCode != kStatus_FLASH_Success)
+    {
+        return returnCode;
+    }
+
+    while (lengthInBytes > 0)
+    {
+        /* preparing passing parameter */
+        kFCCOBx[0] = BYTES_JOIN_TO_WORD_1_3(FTFx_READ_RESOURCE, start);
+        if (flashInfo.resourceCmdAddressAligment == 4)
+        {
+            kFCCOBx[2] = BYTES_JOIN_TO_WORD_1_3(option, 0xFFFFFFU);
+        }
+        else if (flashInfo.resourceCmdAddressAligment == 8)
+        {
+            kFCCOBx[1] = BYTES_JOIN_TO_WORD_1_3(option, 0xFFFFFFU);
+        }
+        else
+        {
+        }
+
+        /* calling flash command sequence function to execute the command */
+        returnCode = flash_command_sequence(config);
+
+        if (kStatus_FLASH_Success != returnCode)
+        {
+            break;
+        }
+
+        /* fetch data */
+        *dst++ = kFCCOBx[1];
+        if (flashInfo.resourceCmdAddressAligment == 8)
+        {
+            *dst++ = kFCCOBx[2];
+        }
+        /* update start address for next iteration */
+        start += flashInfo.resourceCmdAddressAligment;
+        /* update lengthInBytes for next iteration */
+        lengthInBytes -= flashInfo.resourceCmdAddressAligment;
+    }
+
+    return (returnCode);
+}
+#endif /* FSL_FEATURE_FLASH_HAS_READ_RESOURCE_CMD */
 //
 // status_t FLASH_ReadOnce(flash_config_t *config, uint32_t index, uint32_t *dst, uint32_t lengthInBytes)
 // {
@@ -1556,40 +1612,40 @@ status_t FLASH_VerifyProgram(flash_config_t *config,
 //             *value = config->DFlashBlockBase;
 //             break;
 //         case kFLASH_propertyEepromTotalSize:
-//             *value = config->EEpromTotalSize;
-//             break;
-// #endif /* FLASH_SSD_IS_FLEXNVM_ENABLED */
-//
-//         default: /* catch inputs that are not recognized */
-//             return kStatus_FLASH_UnknownProperty;
-//     }
-//
-//     return kStatus_FLASH_Success;
-// }
-
-// #if defined(FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD) && FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD
-// status_t FLASH_SetFlexramFunction(flash_config_t *config, flash_flexram_function_option_t option)
-// {
-//     status_t status;
-//
-//     if (config == NULL)
-//     {
-//         return kStatus_FLASH_InvalidArgument;
-//     }
+//             *value = config->EEpromTotalSize;
+//             break;
+// #endif /* FLASH_SSD_IS_FLEXNVM_ENABLED */
 //
-//     status = flasn_check_flexram_function_option_range(option);
-//     if (status != kStatus_FLASH_Success)
-//     {
-//         return status;
+//         default: /* catch inputs that are not recognized */
+//             return kStatus_FLASH_UnknownProperty;
 //     }
 //
-//     /* preparing passing parameter to verify all block command */
-//     kFCCOBx[0] = BYTES_JOIN_TO_WORD_1_1_2(FTFx_SET_FLEXRAM_FUNCTION, option, 0xFFFFU);
-//
-//     /* calling flash command sequence function to execute the command */
-//     return flash_command_sequence(config);
+//     return kStatus_FLASH_Success;
 // }
-// #endif /* FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD */
+
+#if FLASH_SSD_IS_FLEXNVM_ENABLED && defined(FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD) && FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD
+status_t FLASH_SetFlexramFunction(flash_config_t *config, flash_flexram_function_option_t option)
+{
+    status_t status;
+
+    if (config == NULL)
+    {
+        return kStatus_FLASH_InvalidArgument;
+    }
+
+    status = flasn_check_flexram_function_option_range(option);
+    if (status != kStatus_FLASH_Success)
+    {
+        return status;
+    }
+
+    /* preparing passing parameter to verify all block command */
+    kFCCOBx[0] = BYTES_JOIN_TO_WORD_1_1_2(FTFx_SET_FLEXRAM_FUNCTION, option, 0xFFFFU);
+
+    /* calling flash command sequence function to execute the command */
+    return flash_command_sequence(config);
+}
+#endif /* FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD */
 //
 // #if defined(FSL_FEATURE_FLASH_HAS_SWAP_CONTROL_CMD) && FSL_FEATURE_FLASH_HAS_SWAP_CONTROL_CMD
 // status_t FLASH_SwapControl(flash_config_t *config,
@@ -1983,9 +2039,11 @@ static status_t flash_command_sequence(flash_config_t *config)
 
     /* Check CCIF bit of the flash status register, wait till it is set.
      * IP team indicates that this loop will always complete. */
+    FLASH_STATS_BUSY_BEGIN();
     while (!(FTFx->FSTAT & FTFx_FSTAT_CCIF_MASK))
     {
     }
+    FLASH_STATS_BUSY_END();
 #endif /* FLASH_DRIVER_IS_FLASH_RESIDENT */
 
     /* Check error bits */
@@ -2173,6 +2231,31 @@ void __attribute__((optimize("O0"))) flash_cache_clear(flash_config_t *config)
 #if (defined(__CC_ARM))
 #pragma pop
 #endif
+
+/*!
+ * @brief Flash cache clear after a command
+ *
+ * Erase and program only mark the cache stale when the clear is deferred to FLASH_CacheClear().
+ */
+static void flash_cache_clear_after_command(flash_config_t *config)
+{
+#if FLASH_DRIVER_DEFER_CACHE_CLEAR
+    s_flashCacheClearPending = true;
+#else
+    flash_cache_clear(config);
+#endif
+}
+
+void FLASH_CacheClear(flash_config_t *config)
+{
+#if FLASH_DRIVER_DEFER_CACHE_CLEAR
+    if (s_flashCacheClearPending)
+    {
+        s_flashCacheClearPending = false;
+        flash_cache_clear(config);
+    }
+#endif
+}
 #if (defined(__GNUC__))
 /* #pragma GCC pop_options */
 #endif
@@ -2289,268 +2372,268 @@ static status_t flash_check_user_key(uint32_t key)
     return kStatus_FLASH_Success;
 }
 
-// #if FLASH_SSD_IS_FLEXNVM_ENABLED
-// /*! @brief Updates FlexNVM memory partition status according to data flash 0 IFR.*/
-// static status_t flash_update_flexnvm_memory_partition_status(flash_config_t *config)
-// {
-//     struct
-//     {
-//         uint32_t reserved0;
-//         uint8_t FlexNVMPartitionCode;
-//         uint8_t EEPROMDataSetSize;
-//         uint16_t reserved1;
-//     } dataIFRReadOut;
-//     status_t returnCode;
-//
-//     if (config == NULL)
-//     {
-//         return kStatus_FLASH_InvalidArgument;
-//     }
-//
-//     /* Get FlexNVM memory partition info from data flash IFR */
-//     returnCode = FLASH_ReadResource(config, DFLASH_IFR_READRESOURCE_START_ADDRESS, (uint32_t *)&dataIFRReadOut,
-//                                     sizeof(dataIFRReadOut), kFLASH_resourceOptionFlashIfr);
-//     if (returnCode != kStatus_FLASH_Success)
-//     {
-//         return kStatus_FLASH_PartitionStatusUpdateFailure;
-//     }
-//
-//     /* Fill out partitioned EEPROM size */
-//     dataIFRReadOut.EEPROMDataSetSize &= 0x0FU;
-//     switch (dataIFRReadOut.EEPROMDataSetSize)
-//     {
-//         case 0x00U:
-//             config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_0000;
-//             break;
-//         case 0x01U:
-//             config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_0001;
-//             break;
-//         case 0x02U:
-//             config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_0010;
-//             break;
-//         case 0x03U:
-//             config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_0011;
-//             break;
-//         case 0x04U:
-//             config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_0100;
-//             break;
-//         case 0x05U:
-//             config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_0101;
-//             break;
-//         case 0x06U:
-//             config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_0110;
-//             break;
-//         case 0x07U:
-//             config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_0111;
-//             break;
-//         case 0x08U:
-//             config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_1000;
-//             break;
-//         case 0x09U:
-//             config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_1001;
-//             break;
-//         case 0x0AU:
-//             config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_1010;
-//             break;
-//         case 0x0BU:
-//             config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_1011;
-//             break;
-//         case 0x0CU:
-//             config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_1100;
-//             break;
-//         case 0x0DU:
-//             config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_1101;
-//             break;
-//         case 0x0EU:
-//             config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_1110;
-//             break;
-//         case 0x0FU:
-//             config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_1111;
-//             break;
-//         default:
-//             config->EEpromTotalSize = FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_RESERVED;
-//             break;
-//     }
-//
-//     /* Fill out partitioned DFlash size */
-//     dataIFRReadOut.FlexNVMPartitionCode &= 0x0FU;
-//     switch (dataIFRReadOut.FlexNVMPartitionCode)
-//     {
-//         case 0x00U:
-// #if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0000 != 0xFFFFFFFF)
-//             config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0000;
-// #else
-//             config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
-// #endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0000 */
-//             break;
-//         case 0x01U:
-// #if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0001 != 0xFFFFFFFF)
-//             config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0001;
-// #else
-//             config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
-// #endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0001 */
-//             break;
-//         case 0x02U:
-// #if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0010 != 0xFFFFFFFF)
-//             config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0010;
-// #else
-//             config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
-// #endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0010 */
-//             break;
-//         case 0x03U:
-// #if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0011 != 0xFFFFFFFF)
-//             config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0011;
-// #else
-//             config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
-// #endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0011 */
-//             break;
-//         case 0x04U:
-// #if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0100 != 0xFFFFFFFF)
-//             config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0100;
-// #else
-//             config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
-// #endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0100 */
-//             break;
-//         case 0x05U:
-// #if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0101 != 0xFFFFFFFF)
-//             config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0101;
-// #else
-//             config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
-// #endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0101 */
-//             break;
-//         case 0x06U:
-// #if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0110 != 0xFFFFFFFF)
-//             config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0110;
-// #else
-//             config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
-// #endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0110 */
-//             break;
-//         case 0x07U:
-// #if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0111 != 0xFFFFFFFF)
-//             config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0111;
-// #else
-//             config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
-// #endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0111 */
-//             break;
-//         case 0x08U:
-// #if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1000 != 0xFFFFFFFF)
-//             config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1000;
-// #else
-//             config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
-// #endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1000 */
-//             break;
-//         case 0x09U:
-// #if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1001 != 0xFFFFFFFF)
-//             config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1001;
-// #else
-//             config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
-// #endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1001 */
-//             break;
-//         case 0x0AU:
-// #if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1010 != 0xFFFFFFFF)
-//             config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1010;
-// #else
-//             config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
-// #endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1010 */
-//             break;
-//         case 0x0BU:
-// #if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1011 != 0xFFFFFFFF)
-//             config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1011;
-// #else
-//             config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
-// #endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1011 */
-//             break;
-//         case 0x0CU:
-// #if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1100 != 0xFFFFFFFF)
-//             config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1100;
-// #else
-//             config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
-// #endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1100 */
-//             break;
-//         case 0x0DU:
-// #if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1101 != 0xFFFFFFFF)
-//             config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1101;
-// #else
-//             config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
-// #endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1101 */
-//             break;
-//         case 0x0EU:
-// #if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1110 != 0xFFFFFFFF)
-//             config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1110;
-// #else
-//             config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
-// #endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1110 */
-//             break;
-//         case 0x0FU:
-// #if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1111 != 0xFFFFFFFF)
-//             config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1111;
-// #else
-//             config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
-// #endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1111 */
-//             break;
-//         default:
-//             config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
-//             break;
-//     }
-//
-//     return kStatus_FLASH_Success;
-// }
-// #endif /* FLASH_SSD_IS_FLEXNVM_ENABLED */
+#if FLASH_SSD_IS_FLEXNVM_ENABLED
+/*! @brief Updates FlexNVM memory partition status according to data flash 0 IFR.*/
+static status_t flash_update_flexnvm_memory_partition_status(flash_config_t *config)
+{
+    struct
+    {
+        uint32_t reserved0;
+        uint8_t FlexNVMPartitionCode;
+        uint8_t EEPROMDataSetSize;
+        uint16_t reserved1;
+    } dataIFRReadOut;
+    status_t returnCode;
 
-// #if defined(FSL_FEATURE_FLASH_HAS_READ_RESOURCE_CMD) && FSL_FEATURE_FLASH_HAS_READ_RESOURCE_CMD
-// /*! @brief Validates the range of the given resource address.*/
-// static status_t flash_check_resource_range(uint32_t start,
-//                                            uint32_t lengthInBytes,
-//                                            uint32_t alignmentBaseline,
-//                                            flash_read_resource_option_t option)
-// {
-//     status_t status;
-//     uint32_t maxReadbleAddress;
-//
-//     if ((start & (alignmentBaseline - 1)) || (lengthInBytes & (alignmentBaseline - 1)))
-//     {
-//         return kStatus_FLASH_AlignmentError;
-//     }
-//
-//     status = kStatus_FLASH_Success;
-//
-//     maxReadbleAddress = start + lengthInBytes - 1;
-//     if (option == kFLASH_resourceOptionVersionId)
-//     {
-//         if ((start != kFLASH_resourceRangeVersionIdStart) ||
-//             ((start + lengthInBytes - 1) != kFLASH_resourceRangeVersionIdEnd))
-//         {
-//             status = kStatus_FLASH_InvalidArgument;
-//         }
-//     }
-//     else if (option == kFLASH_resourceOptionFlashIfr)
-//     {
-//         if (maxReadbleAddress < kFLASH_resourceRangePflashIfrSizeInBytes)
-//         {
-//         }
-// #if defined(FSL_FEATURE_FLASH_HAS_PFLASH_BLOCK_SWAP) && FSL_FEATURE_FLASH_HAS_PFLASH_BLOCK_SWAP
-//         else if ((start >= kFLASH_resourceRangePflashSwapIfrStart) &&
-//                  (maxReadbleAddress <= kFLASH_resourceRangePflashSwapIfrEnd))
-//         {
-//         }
-// #endif /* FSL_FEATURE_FLASH_HAS_PFLASH_BLOCK_SWAP */
-//         else if ((start >= kFLASH_resourceRangeDflashIfrStart) &&
-//                  (maxReadbleAddress <= kFLASH_resourceRangeDflashIfrEnd))
-//         {
-//         }
-//         else
-//         {
-//             status = kStatus_FLASH_InvalidArgument;
-//         }
-//     }
-//     else
-//     {
-//         status = kStatus_FLASH_InvalidArgument;
-//     }
-//
-//     return status;
-// }
-// #endif /* FSL_FEATURE_FLASH_HAS_READ_RESOURCE_CMD */
+    if (config == NULL)
+    {
+        return kStatus_FLASH_InvalidArgument;
+    }
+
+    /* Get FlexNVM memory partition info from data flash IFR */
+    returnCode = FLASH_ReadResource(config, DFLASH_IFR_READRESOURCE_START_ADDRESS, (uint32_t *)&dataIFRReadOut,
+                                    sizeof(dataIFRReadOut), kFLASH_resourceOptionFlashIfr);
+    if (returnCode != kStatus_FLASH_Success)
+    {
+        return kStatus_FLASH_PartitionStatusUpdateFailure;
+    }
+
+    /* Fill out partitioned EEPROM size */
+    dataIFRReadOut.EEPROMDataSetSize &= 0x0FU;
+    switch (dataIFRReadOut.EEPROMDataSetSize)
+    {
+        case 0x00U:
+            config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_0000;
+            break;
+        case 0x01U:
+            config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_0001;
+            break;
+        case 0x02U:
+            config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_0010;
+            break;
+        case 0x03U:
+            config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_0011;
+            break;
+        case 0x04U:
+            config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_0100;
+            break;
+        case 0x05U:
+            config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_0101;
+            break;
+        case 0x06U:
+            config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_0110;
+            break;
+        case 0x07U:
+            config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_0111;
+            break;
+        case 0x08U:
+            config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_1000;
+            break;
+        case 0x09U:
+            config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_1001;
+            break;
+        case 0x0AU:
+            config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_1010;
+            break;
+        case 0x0BU:
+            config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_1011;
+            break;
+        case 0x0CU:
+            config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_1100;
+            break;
+        case 0x0DU:
+            config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_1101;
+            break;
+        case 0x0EU:
+            config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_1110;
+            break;
+        case 0x0FU:
+            config->EEpromTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_1111;
+            break;
+        default:
+            config->EEpromTotalSize = FLEX_NVM_EEPROM_SIZE_FOR_EEESIZE_RESERVED;
+            break;
+    }
+
+    /* Fill out partitioned DFlash size */
+    dataIFRReadOut.FlexNVMPartitionCode &= 0x0FU;
+    switch (dataIFRReadOut.FlexNVMPartitionCode)
+    {
+        case 0x00U:
+#if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0000 != 0xFFFFFFFF)
+            config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0000;
+#else
+            config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
+#endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0000 */
+            break;
+        case 0x01U:
+#if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0001 != 0xFFFFFFFF)
+            config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0001;
+#else
+            config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
+#endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0001 */
+            break;
+        case 0x02U:
+#if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0010 != 0xFFFFFFFF)
+            config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0010;
+#else
+            config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
+#endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0010 */
+            break;
+        case 0x03U:
+#if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0011 != 0xFFFFFFFF)
+            config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0011;
+#else
+            config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
+#endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0011 */
+            break;
+        case 0x04U:
+#if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0100 != 0xFFFFFFFF)
+            config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0100;
+#else
+            config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
+#endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0100 */
+            break;
+        case 0x05U:
+#if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0101 != 0xFFFFFFFF)
+            config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0101;
+#else
+            config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
+#endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0101 */
+            break;
+        case 0x06U:
+#if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0110 != 0xFFFFFFFF)
+            config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0110;
+#else
+            config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
+#endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0110 */
+            break;
+        case 0x07U:
+#if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0111 != 0xFFFFFFFF)
+            config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0111;
+#else
+            config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
+#endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_0111 */
+            break;
+        case 0x08U:
+#if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1000 != 0xFFFFFFFF)
+            config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1000;
+#else
+            config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
+#endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1000 */
+            break;
+        case 0x09U:
+#if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1001 != 0xFFFFFFFF)
+            config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1001;
+#else
+            config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
+#endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1001 */
+            break;
+        case 0x0AU:
+#if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1010 != 0xFFFFFFFF)
+            config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1010;
+#else
+            config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
+#endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1010 */
+            break;
+        case 0x0BU:
+#if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1011 != 0xFFFFFFFF)
+            config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1011;
+#else
+            config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
+#endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1011 */
+            break;
+        case 0x0CU:
+#if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1100 != 0xFFFFFFFF)
+            config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1100;
+#else
+            config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
+#endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1100 */
+            break;
+        case 0x0DU:
+#if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1101 != 0xFFFFFFFF)
+            config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1101;
+#else
+            config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
+#endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1101 */
+            break;
+        case 0x0EU:
+#if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1110 != 0xFFFFFFFF)
+            config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1110;
+#else
+            config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
+#endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1110 */
+            break;
+        case 0x0FU:
+#if (FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1111 != 0xFFFFFFFF)
+            config->DFlashTotalSize = FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1111;
+#else
+            config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
+#endif /* FSL_FEATURE_FLASH_FLEX_NVM_DFLASH_SIZE_FOR_DEPART_1111 */
+            break;
+        default:
+            config->DFlashTotalSize = FLEX_NVM_DFLASH_SIZE_FOR_DEPART_RESERVED;
+            break;
+    }
+
+    return kStatus_FLASH_Success;
+}
+#endif /* FLASH_SSD_IS_FLEXNVM_ENABLED */
+
+#if FLASH_SSD_IS_FLEXNVM_ENABLED && defined(FSL_FEATURE_FLASH_HAS_READ_RESOURCE_CMD) && FSL_FEATURE_FLASH_HAS_READ_RESOURCE_CMD
+/*! @brief Validates the range of the given resource address.*/
+static status_t flash_check_resource_range(uint32_t start,
+                                           uint32_t lengthInBytes,
+                                           uint32_t alignmentBaseline,
+                                           flash_read_resource_option_t option)
+{
+    status_t status;
+    uint32_t maxReadbleAddress;
+
+    if ((start & (alignmentBaseline - 1)) || (lengthInBytes & (alignmentBaseline - 1)))
+    {
+        return kStatus_FLASH_AlignmentError;
+    }
+
+    status = kStatus_FLASH_Success;
+
+    maxReadbleAddress = start + lengthInBytes - 1;
+    if (option == kFLASH_resourceOptionVersionId)
+    {
+        if ((start != kFLASH_resourceRangeVersionIdStart) ||
+            ((start + lengthInBytes - 1) != kFLASH_resourceRangeVersionIdEnd))
+        {
+            status = kStatus_FLASH_InvalidArgument;
+        }
+    }
+    else if (option == kFLASH_resourceOptionFlashIfr)
+    {
+        if (maxReadbleAddress < kFLASH_resourceRangePflashIfrSizeInBytes)
+        {
+        }
+#if defined(FSL_FEATURE_FLASH_HAS_PFLASH_BLOCK_SWAP) && FSL_FEATURE_FLASH_HAS_PFLASH_BLOCK_SWAP
+        else if ((start >= kFLASH_resourceRangePflashSwapIfrStart) &&
+                 (maxReadbleAddress <= kFLASH_resourceRangePflashSwapIfrEnd))
+        {
+        }
+#endif /* FSL_FEATURE_FLASH_HAS_PFLASH_BLOCK_SWAP */
+        else if ((start >= kFLASH_resourceRangeDflashIfrStart) &&
+                 (maxReadbleAddress <= kFLASH_resourceRangeDflashIfrEnd))
+        {
+        }
+        else
+        {
+            status = kStatus_FLASH_InvalidArgument;
+        }
+    }
+    else
+    {
+        status = kStatus_FLASH_InvalidArgument;
+    }
+
+    return status;
+}
+#endif /* FSL_FEATURE_FLASH_HAS_READ_RESOURCE_CMD */
 
 // #if defined(FSL_FEATURE_FLASH_HAS_SWAP_CONTROL_CMD) && FSL_FEATURE_FLASH_HAS_SWAP_CONTROL_CMD
 // /*! @brief Validates the gived swap control option.*/
@@ -2595,16 +2678,16 @@ static status_t flash_check_user_key(uint32_t key)
 // }
 // #endif /* FSL_FEATURE_FLASH_HAS_PFLASH_BLOCK_SWAP */
 //
-// #if defined(FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD) && FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD
-// /*! @brief Validates the gived flexram function option.*/
-// static inline status_t flasn_check_flexram_function_option_range(flash_flexram_function_option_t option)
-// {
-//     if ((option != kFLASH_flexramFunctionOptionAvailableAsRam) &&
-//         (option != kFLASH_flexramFunctionOptionAvailableForEeprom))
-//     {
-//         return kStatus_FLASH_InvalidArgument;
-//     }
-//
-//     return kStatus_FLASH_Success;
-// }
-// #endif /* FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD */
+#if FLASH_SSD_IS_FLEXNVM_ENABLED && defined(FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD) && FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD
+/*! @brief Validates the gived flexram function option.*/
+static inline status_t flasn_check_flexram_function_option_range(flash_flexram_function_option_t option)
+{
+    if ((option != kFLASH_flexramFunctionOptionAvailableAsRam) &&
+        (option != kFLASH_flexramFunctionOptionAvailableForEeprom))
+    {
+        return kStatus_FLASH_InvalidArgument;
+    }
+
+    return kStatus_FLASH_Success;
+}
+#endif /* FSL_FEATURE_FLASH_HAS_SET_FLEXRAM_FUNCTION_CMD */
@@ -100,6 +100,11 @@ enum _flash_driver_version_constants
 #define FLASH_DRIVER_IS_EXPORTED 0 /*!< Used for SDK application. */
 #endif
 #endif
+
+/*! @brief Whether the flash cache clear after erase and program is deferred to FLASH_CacheClear() */
+#if !defined(FLASH_DRIVER_DEFER_CACHE_CLEAR)
+#define FLASH_DRIVER_DEFER_CACHE_CLEAR 0 /*!< Clear the cache after every erase and program by default. */
+#endif
 /*@}*/
 
 /*!
@@ -481,6 +486,17 @@ status_t FLASH_SetCallback(flash_config_t *config, flash_callback_t callback);
 status_t FLASH_PrepareExecuteInRamFunctions(flash_config_t *config);
 #endif
 
+/*!
+ * @brief Clear the flash cache if erase or program left it stale
+ *
+ * With FLASH_DRIVER_DEFER_CACHE_CLEAR the erase and program APIs only mark the
+ * cache as stale; call this once a batch is done, before flash is read again.
+ * Without it the cache is already cleared by every erase and program call.
+ *
+ * @param config Pointer to storage for the driver runtime state.
+ */
+void FLASH_CacheClear(flash_config_t *config);
+
 /*@}*/
 
 /*!
@@ -530,6 +546,28 @@ status_t FLASH_EraseAll(flash_config_t *config, uint32_t key);
  */
 status_t FLASH_Erase(flash_config_t *config, uint32_t start, uint32_t lengthInBytes, uint32_t key);
 
+/*!
+ * @brief Erases the D-Flash block containing the given address
+ *
+ * This function erases a whole FlexNVM block with one Erase Flash Block command.
+ * The command is rejected when part of the block is partitioned as EEPROM backup.
+ *
+ * @param config Pointer to storage for the driver runtime state.
+ * @param start An address inside the D-Flash block to be erased.
+ * @param key value used to validate all flash erase APIs.
+ *
+ * @retval #kStatus_FLASH_Success Api was executed successfully.
+ * @retval #kStatus_FLASH_InvalidArgument Invalid argument is provided.
+ * @retval #kStatus_FLASH_AddressError Address is out of range.
+ * @retval #kStatus_FLASH_EraseKeyError Api erase key is invalid.
+ * @retval #kStatus_FLASH_AccessError Invalid instruction codes and out-of bounds addresses.
+ * @retval #kStatus_FLASH_ProtectionViolation The program/erase operation is requested to execute on protected areas.
+ * @retval #kStatus_FLASH_CommandFailure Run-time error during command execution.
+ */
+#if FLASH_SSD_IS_FLEXNVM_ENABLED
+status_t FLASH_EraseBlock(flash_config_t *config, uint32_t start, uint32_t key);
+#endif
+
 /*!
  * @brief Erases entire flash, including protected sectors.
  *
@@ -25,6 +25,8 @@
  * --------------------------------------------------------------------------- */
 
 /* History:
+ *  Version 1.01
+ *    Optional PLL clock boost (FMC_CLK_BOOST), PG held across ProgramPage
  *  Version 1.00
  *    Initial release
  */ 
@@ -49,9 +51,11 @@ unsigned long    base_adr;
 
 // Peripheral Memory Map
 #define FWDGT_BASE                 0x40003000
+#define RCU_BASE                   0x40021000
 #define FMC_BASE                   0x40022000
 
 #define FWDGT                      FWDGT_BASE
+#define RCU                        RCU_BASE
 #define FMC                        FMC_BASE
 
 
@@ -61,6 +65,10 @@ unsigned long    base_adr;
 #define FWDGT_RLD                  REG32((FWDGT) + 0x08U)         /*!< FWDGT reload register */
 #define FWDGT_STAT                 REG32((FWDGT) + 0x0CU)         /*!< FWDGT status register */
 
+// RCU
+#define RCU_CTL                    REG32((RCU) + 0x00U)           /*!< control register */
+#define RCU_CFG0                   REG32((RCU) + 0x04U)           /*!< clock configuration register 0 */
+
 // FMC
 #define FMC_WS                     REG32((FMC) + 0x00U)           /*!< FMC wait state register */
 #define FMC_KEY0                   REG32((FMC) + 0x04U)           /*!< FMC unlock key register 0 */
@@ -78,6 +86,24 @@ unsigned long    base_adr;
 #endif
 
 
+// RCU Register definitions
+#define RCU_CTL_IRC8MEN            BIT(0)                         /*!< internal high speed oscillator enable */
+#define RCU_CTL_IRC8MSTB           BIT(1)                         /*!< IRC8M high speed internal oscillator stabilization flag */
+#define RCU_CTL_PLLEN              BIT(24)                        /*!< PLL enable */
+#define RCU_CTL_PLLSTB             BIT(25)                        /*!< PLL clock stabilization flag */
+
+#define RCU_CFG0_SCS               (BIT(0) | BIT(1))              /*!< system clock switch */
+#define RCU_CFG0_SCSS              (BIT(2) | BIT(3))              /*!< system clock switch status */
+#define RCU_CFG0_APB1PSC           (BIT(8) | BIT(9) | BIT(10))    /*!< APB1 prescaler selection */
+#define RCU_CFG0_PLLSEL            BIT(16)                        /*!< PLL clock source selection */
+#define RCU_CFG0_PLLMF             (BIT(18) | BIT(19) | BIT(20) | BIT(21) | BIT(27) | BIT(30)) /*!< PLL multiply factor */
+
+#define RCU_SCS_IRC8M              0x00000000U                    /*!< system clock source select IRC8M */
+#define RCU_SCS_PLL                0x00000002U                    /*!< system clock source select PLL */
+#define RCU_SCSS_PLL               0x00000008U                    /*!< system clock source is PLL */
+#define RCU_APB1_CKAHB_DIV2        (4U << 8)                      /*!< APB1 prescaler select CK_AHB/2 */
+#define RCU_PLL_MUL30              (BIT(27) | (13U << 18))        /*!< PLL source clock multiply by 30 */
+
 // FMC Control Register definitions
 #define FMC_CTL0_PG                BIT(0)                         /*!< main flash program for bank0 command bit */
 #define FMC_CTL0_PER               BIT(1)                         /*!< main flash page erase for bank0 command bit */
@@ -117,6 +143,59 @@ unsigned long    base_adr;
 // FMC BANK size
 #define BANK1_SIZE                 0x00080000             
 
+// FMC wait states while running from the PLL (IRC8M/2 * 30 = 120 MHz)
+#define FMC_WS_BOOST               0x00000003U
+
+#ifdef FMC_CLK_BOOST
+unsigned long    rcu_ctl_saved;
+unsigned long    rcu_cfg0_saved;
+unsigned long    fmc_ws_saved;
+unsigned long    clk_boosted;
+
+static void ClockBoost(void)
+{
+    if(clk_boosted){                                 // Init again without UnInit, keep the saved clock tree
+        return;
+    }
+    if((RCU_CFG0 & RCU_CFG0_SCSS) != RCU_SCS_IRC8M){ // Leave a clock tree set up by the application alone
+        clk_boosted = 0;
+        return;
+    }
+
+    rcu_ctl_saved  = RCU_CTL;
+    rcu_cfg0_saved = RCU_CFG0;
+    fmc_ws_saved   = FMC_WS;
+
+    FMC_WS    = FMC_WS_BOOST;                        // Wait States before raising HCLK
+    RCU_CFG0  = (RCU_CFG0 & ~(RCU_CFG0_PLLSEL | RCU_CFG0_PLLMF | RCU_CFG0_APB1PSC))
+              | RCU_PLL_MUL30                        // PLL source IRC8M/2
+              | RCU_APB1_CKAHB_DIV2;                 // APB1 limited to 60 MHz
+    RCU_CTL  |= RCU_CTL_PLLEN;
+    while((RCU_CTL & RCU_CTL_PLLSTB) == 0);
+
+    RCU_CFG0  = (RCU_CFG0 & ~RCU_CFG0_SCS) | RCU_SCS_PLL;
+    while((RCU_CFG0 & RCU_CFG0_SCSS) != RCU_SCSS_PLL);
+
+    clk_boosted = 1;
+}
+
+static void ClockRestore(void)
+{
+    if(!clk_boosted){
+        return;
+    }
+
+    RCU_CFG0  = (RCU_CFG0 & ~RCU_CFG0_SCS) | RCU_SCS_IRC8M;
+    while((RCU_CFG0 & RCU_CFG0_SCSS) != RCU_SCS_IRC8M);
+
+    RCU_CTL   = rcu_ctl_saved;                       // PLL off again
+    RCU_CFG0  = rcu_cfg0_saved;
+    FMC_WS    = fmc_ws_saved;                        // Wait States after lowering HCLK
+
+    clk_boosted = 0;
+}
+#endif
+
 
 
 #ifdef FMC_OB
@@ -146,7 +225,11 @@ int Init(unsigned long adr, unsigned long clk, unsigned long fnc)
 int Init(unsigned long adr, unsigned long clk, unsigned long fnc)
 {
     base_adr = adr & ~(BANK1_SIZE - 1);              // Align to Size Boundary
+#ifdef FMC_CLK_BOOST
+    ClockBoost();                                    // PLL and matching Wait States
+#else
     FMC_WS  = 0x00000000;                            // Zero Wait State
+#endif
     FMC_KEY0  = UNLOCK_KEY0;                         // Unlock FMC 
     FMC_KEY0  = UNLOCK_KEY1;
 
@@ -183,6 +266,9 @@ int UnInit(unsigned long fnc)
     FMC_CTL0  |=  FMC_CTL0_LK;                        // Lock FMC
 #if defined GD32F30X_XD || defined GD32F30X_CL
     FMC_CTL1  |=  FMC_CTL1_LK;                        // Lock FMC
+#endif
+#ifdef FMC_CLK_BOOST
+    ClockRestore();                                   // Back to IRC8M
 #endif
     return(0);
 } 
@@ -196,18 +282,22 @@ int EraseChip(void)
     FMC_CTL0 |=  FMC_CTL0_OBER;                       // Option Byte Erase Enabled 
     FMC_CTL0 |=  FMC_CTL0_START;                      // Start Erase
 
+    FLASH_STATS_BUSY_BEGIN();
     while(FMC_STAT0 & FMC_STAT0_BUSY){
         FWDGT_CTL = 0xAAAA;                           // Reload FWDGT
     }
+    FLASH_STATS_BUSY_END();
 
     FMC_CTL0 &= ~FMC_CTL0_OBER;                       // Option Byte Erase Disabled 
                                                       // Unprotect FMC
     FMC_CTL0 |=  FMC_CTL0_OBPG;                       // Option Byte Programming Enabled
 
     M16(0x1FFFF800) = RDPT_KEY;                       // Program Half Word: RDPRT Key
+    FLASH_STATS_BUSY_BEGIN();
     while(FMC_STAT0 & FMC_STAT0_BUSY){
         FWDGT_CTL = 0xAAAA;                           // Reload FWDGT
     }
+    FLASH_STATS_BUSY_END();
 
     FMC_CTL0 &= ~FMC_CTL0_OBPG;                       // Option Byte Programming Disabled
 
@@ -226,9 +316,11 @@ int EraseChip(void)
     FMC_CTL0  |=  FMC_CTL0_MER;                       // Mass Erase Enabled
     FMC_CTL0  |=  FMC_CTL0_START;                     // Start Erase
 
+    FLASH_STATS_BUSY_BEGIN();
     while(FMC_STAT0  & FMC_STAT0_BUSY){
         FWDGT_CTL = 0xAAAA;                           // Reload FWDGT
     }
+    FLASH_STATS_BUSY_END();
 
     FMC_CTL0  &= ~FMC_CTL0_MER;                       // Mass Erase Disabled
 
@@ -237,9 +329,11 @@ int EraseChip(void)
     FMC_CTL1  |=  FMC_CTL1_MER;                       // Mass Erase Enabled
     FMC_CTL1  |=  FMC_CTL1_START;                     // Start Erase
 
+    FLASH_STATS_BUSY_BEGIN();
     while (FMC_STAT1  & FMC_STAT1_BUSY){
         FWDGT_CTL = 0xAAAA;                           // Reload FWDGT
     }
+    FLASH_STATS_BUSY_END();
 
     FMC_CTL1  &= ~FMC_CTL1_MER;                       // Mass Erase Disabled
 #endif
@@ -256,9 +350,11 @@ int EraseSector(unsigned long adr)
     FMC_CTL0 |=  FMC_CTL0_OBER;                       // Option Byte Erase Enabled 
     FMC_CTL0 |=  FMC_CTL0_START;                      // Start Erase
 
+    FLASH_STATS_BUSY_BEGIN();
     while(FMC_STAT0 & FMC_STAT0_BUSY){
         FWDGT_CTL = 0xAAAA;                           // Reload FWDGT
     }
+    FLASH_STATS_BUSY_END();
 
     FMC_CTL0 &= ~FMC_CTL0_OBER;                       // Option Byte Erase Disabled 
 
@@ -276,9 +372,11 @@ int EraseSector(unsigned long adr)
         FMC_ADDR0 =  adr;                              // Page Address
         FMC_CTL0  |=  FMC_CTL0_START;                  // Start Erase
 
+        FLASH_STATS_BUSY_BEGIN();
         while(FMC_STAT0  & FMC_STAT0_BUSY){
             FWDGT_CTL = 0xAAAA;                        // Reload FWDGT
         }
+        FLASH_STATS_BUSY_END();
 
         FMC_CTL0  &= ~FMC_CTL0_PER;                    // Page Erase Disabled 
 
@@ -289,9 +387,11 @@ int EraseSector(unsigned long adr)
         FMC_ADDR1 =  adr;                              // Page Address
         FMC_CTL1  |=  FMC_CTL1_START;                  // Start Erase
 
+        FLASH_STATS_BUSY_BEGIN();
         while(FMC_STAT1  & FMC_STAT1_BUSY){
             FWDGT_CTL = 0xAAAA;                        // Reload FWDGT
         }
+        FLASH_STATS_BUSY_END();
 
         FMC_CTL1  &= ~FMC_CTL1_PER;                    // Page Erase Disabled 
 
@@ -320,9 +420,11 @@ int ProgramPage(unsigned long adr, unsigned long sz, unsigned char *buf)
         FMC_CTL0 |=  FMC_CTL0_OBPG;                     // Option Byte Programming Enabled
 
         M16(adr) = *((unsigned short *)buf);            // Program Half Word
+        FLASH_STATS_BUSY_BEGIN();
         while(FMC_STAT0 & FMC_STAT0_BUSY){
             FWDGT_CTL = 0xAAAA;                         // Reload FWDGT
         }
+        FLASH_STATS_BUSY_END();
 
         FMC_CTL0 &= ~FMC_CTL0_OBPG;                     // Options Byte Programming Disabled
 
@@ -349,45 +451,49 @@ int ProgramPage(unsigned long adr, unsigned long sz, unsigned char *buf)
 #if defined GD32F30X_XD || defined GD32F30X_CL
     if(adr < (base_adr + BANK1_SIZE)){              // Flash bank 2
 #endif   
-        while(sz){
-            FMC_CTL0  |=  FMC_CTL0_PG;              // Programming Enabled
+        FMC_CTL0  |=  FMC_CTL0_PG;                  // Programming Enabled for the whole page
 
+        while(sz){
             M32(adr) = *((unsigned long *)buf);     // Program Word
+            FLASH_STATS_BUSY_BEGIN();
             while(FMC_STAT0  & FMC_STAT0_BUSY);
-
-            FMC_CTL0  &= ~FMC_CTL0_PG;              // Programming Disabled
-
-                                                    // Check for Errors
-            if(FMC_STAT0 & (FMC_STAT0_PGERR | FMC_STAT0_WPERR)){
-                FMC_STAT0 |= FMC_STAT0_PGERR | FMC_STAT0_WPERR;
-                return(1);                          // Failed
-            }
+            FLASH_STATS_BUSY_END();
                                                     // Go to next  Word
             adr += 4;
             buf += 4;
             sz  -= 4;
         }
 
+        FMC_CTL0  &= ~FMC_CTL0_PG;                  // Programming Disabled
+
+                                                    // Check for Errors
+        if(FMC_STAT0 & (FMC_STAT0_PGERR | FMC_STAT0_WPERR)){
+            FMC_STAT0 |= FMC_STAT0_PGERR | FMC_STAT0_WPERR;
+            return(1);                              // Failed
+        }
+
 #if defined GD32F30X_XD || defined GD32F30X_CL
     }else{
-        while(sz){
-            FMC_CTL1  |=  FMC_CTL1_PG;               // Programming Enabled
+        FMC_CTL1  |=  FMC_CTL1_PG;                   // Programming Enabled for the whole page
 
+        while(sz){
             M32(adr) = *((unsigned long *)buf);      // Program Word
+            FLASH_STATS_BUSY_BEGIN();
             while(FMC_STAT1  & FMC_STAT1_BUSY);
-
-            FMC_CTL1  &= ~FMC_CTL1_PG;               // Programming Disabled
-
-                                                     // Check for Errors
-            if(FMC_STAT1 & (FMC_STAT1_PGERR | FMC_STAT1_WPERR)){
-                FMC_STAT1 |= FMC_STAT1_PGERR | FMC_STAT1_WPERR;
-                return(1);                          // Failed
-            }
+            FLASH_STATS_BUSY_END();
                                                      // Go to next  Word
             adr += 4;
             buf += 4;
             sz  -= 4;
         }
+
+        FMC_CTL1  &= ~FMC_CTL1_PG;                   // Programming Disabled
+
+                                                     // Check for Errors
+        if(FMC_STAT1 & (FMC_STAT1_PGERR | FMC_STAT1_WPERR)){
+            FMC_STAT1 |= FMC_STAT1_PGERR | FMC_STAT1_WPERR;
+            return(1);                              // Failed
+        }
     }
 #endif
     return(0);                                      // Done
@@ -56,6 +56,12 @@
 #define WDT_REG_CONFIG        *((volatile U32*)(WDT_REGS_BASE_ADDR + 0x50C))
 #define WDT_REG_RR0           *((volatile U32*)(WDT_REGS_BASE_ADDR + 0x600))  // 8 registers, each 4 bytes in size
 
+//
+// Words programmed between two watchdog feeds while programming (~40us each).
+// Keeps the shortest sensible watchdog period safe without servicing it per poll.
+//
+#define WDT_FEED_INTERVAL     (16)
+
 /*
  *  Feed watchdog, if running
  */
@@ -80,6 +86,25 @@ static void _FeedWDT(void)
     }
 }
 
+/*
+ *  Check if a flash page is erased, using a fast word scan
+ */
+static int _IsBlank(U32 Addr, U32 NumBytes)
+{
+    volatile U32* p;
+    U32 NumBlocks;
+
+    p = (volatile U32*)Addr;
+    NumBlocks = NumBytes >> 4;      // 4 words per iteration, page size is a multiple of 16
+    do {
+        if ((p[0] & p[1] & p[2] & p[3]) != 0xFFFFFFFF) {
+            return 0;
+        }
+        p += 4;
+    } while(--NumBlocks);
+    return 1;
+}
+
 /*
  *  Erase a single flash sector
  */
@@ -101,6 +126,7 @@ static void _EraseSector(U32 Addr)
     //
     // Wait for operation to complete
     //
+    FLASH_STATS_BUSY_BEGIN();
     do {
         _FeedWDT();
         Status = FLASH_REG_READY;
@@ -108,6 +134,7 @@ static void _EraseSector(U32 Addr)
           break;
         }
     } while(1);
+    FLASH_STATS_BUSY_END();
     //
     // Bring back flash controller into read mode
     //
@@ -164,6 +191,7 @@ int EraseChip (void)
     //
     // Wait for operation to complete
     //
+    FLASH_STATS_BUSY_BEGIN();
     do {
 		    Status = FLASH_REG_READY;
 		    if (Status & 1) {        // Flash controller ready?
@@ -171,6 +199,7 @@ int EraseChip (void)
 		    }
 		    _FeedWDT();
     } while(1);
+    FLASH_STATS_BUSY_END();
     //
     // Bring back flash controller into read mode
     //
@@ -185,6 +214,12 @@ int EraseChip (void)
  */
 int EraseSector (unsigned long adr)
 {
+    //
+    // Skip CODE pages which are erased already, erase takes ~20ms
+    //
+    if ((adr < 0x10001000) && _IsBlank(adr, INFO_REG_CODEPAGESIZE)) {
+        return (0);
+    }
     _EraseSector(adr);
     return (0);
 }
@@ -201,7 +236,7 @@ int ProgramPage (unsigned long adr, unsigned long sz, unsigned char *buf)
     volatile U32* pDest;
     volatile U32* pSrc;
     U32 NumWords;
-    U32 Status;
+    U32 FeedCnt;
 	
     pDest = (volatile U32*)adr;
     pSrc = (volatile U32*)buf;    // Always 32-bit aligned. Made sure by CMSIS-DAP firmware
@@ -210,6 +245,8 @@ int ProgramPage (unsigned long adr, unsigned long sz, unsigned char *buf)
     // sz is always a multiple of "Programming Page Size"
     //
     NumWords = sz >> 2;	
+    FeedCnt = WDT_FEED_INTERVAL;
+    _FeedWDT();
     //
     // Make sure that flash controller is in write mode
     //
@@ -222,13 +259,16 @@ int ProgramPage (unsigned long adr, unsigned long sz, unsigned char *buf)
         //
         // Wait for operation to complete
         //
-        do {
-            Status = FLASH_REG_READY;
-            if (Status & 1) {        // Flash controller ready?
-                break;
-            }
+        FLASH_STATS_BUSY_BEGIN();
+        while ((FLASH_REG_READY & 1) == 0);
+        FLASH_STATS_BUSY_END();
+        //
+        // Feed watchdog every WDT_FEED_INTERVAL words only
+        //
+        if (--FeedCnt == 0) {
+            FeedCnt = WDT_FEED_INTERVAL;
             _FeedWDT();
-        } while(1);
+        }
     } while(--NumWords);
     //
     // Bring back flash controller into read mode
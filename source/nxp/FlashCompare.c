@@ -0,0 +1,51 @@
+/* Flash OS Routines
+ * Copyright (c) 2009-2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file FlashCompare.c */
+
+#include "FlashCompare.h"
+
+/* Shared by the NXP IAP drivers for BlankCheck and Verify */
+
+unsigned long CompareWords (unsigned long adr, unsigned long sz, unsigned char *buf, unsigned char pat)
+{
+    unsigned long w = pat * 0x01010101UL;
+
+    if (((adr | (unsigned long)buf) & 3) == 0) {
+        while (sz >= 4) {                        // Word Compare
+            if (*((volatile unsigned long *)adr) != (buf ? *((unsigned long *)buf) : w)) {
+                break;
+            }
+            adr += 4;
+            if (buf) {
+                buf += 4;
+            }
+            sz  -= 4;
+        }
+    }
+    while (sz) {                                 // Locate Byte / Remaining Bytes
+        if (*((volatile unsigned char *)adr) != (buf ? *buf : pat)) {
+            break;
+        }
+        adr += 1;
+        if (buf) {
+            buf += 1;
+        }
+        sz  -= 1;
+    }
+
+    return (adr);
+}
@@ -0,0 +1,32 @@
+/* Flash OS Routines
+ * Copyright (c) 2009-2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file FlashCompare.h */
+
+#ifndef FLASHCOMPARE_H
+#define FLASHCOMPARE_H
+
+/*
+ *  Compare Flash Memory with a Pattern or Buffer (fallback for the ROM checks)
+ *    Parameter:      adr:  Memory Address
+ *                    sz:   Block Size (in bytes)
+ *                    buf:  Data to compare against, 0 to compare with pat
+ *                    pat:  Pattern used when buf is 0
+ *    Return Value:   Address of first mismatch, (adr+sz) - all equal
+ */
+unsigned long CompareWords (unsigned long adr, unsigned long sz, unsigned char *buf, unsigned char pat);
+
+#endif
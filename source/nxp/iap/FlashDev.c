@@ -15,6 +15,7 @@
  */
 
 #include "../FlashOS.H"        // FlashOS Structures
+#include "FlashDev.h"
 
 #ifdef MBED
 #ifdef LPC1700_512
@@ -24,7 +25,7 @@ struct FlashDevice const FlashDevice  =  {
    ONCHIP,                     // Device Type
    0x00000000,                 // Device Start Address
    0x00080000,                 // Device Size (512kB)
-   1024,                       // Programming Page Size
+   IAP_PAGE_SIZE,              // Programming Page Size
    0,                          // Reserved, must be 0
    0xFF,                       // Initial Content of Erased Memory
    100,                        // Program Page Timeout 100 mSec
@@ -43,7 +44,7 @@ struct FlashDevice const FlashDevice  =  {
    ONCHIP,                     // Device Type
    0x00000000,                 // Device Start Address
    0x00008000,                 // Device Size (32kB)
-   1024,                       // Programming Page Size
+   IAP_PAGE_SIZE,              // Programming Page Size
    0,                          // Reserved, must be 0
    0xFF,                       // Initial Content of Erased Memory
    300,                        // Program Page Timeout 300 mSec
@@ -61,14 +62,18 @@ struct FlashDevice const FlashDevice  =  {
    ONCHIP,                     // Device Type
    0x00000000,                 // Device Start Address
    0x00001000,                 // Device Size (4kB)
-   256,                        // Programming Page Size
+   IAP_PAGE_SIZE,              // Programming Page Size
    0,                          // Reserved, must be 0
    0xFF,                       // Initial Content of Erased Memory
    300,                        // Program Page Timeout 300 mSec
    3000,                       // Erase Sector Timeout 3000 mSec
 
 // Specify Size and Address of Sectors
+#ifdef IAP_ERASE_PAGE
+   IAP_ERASE_SIZE, 0x000000,   // Erase Page Size
+#else
    0x000400, 0x000000,         // Sector Size  1kB (4 Sectors)
+#endif
    SECTOR_END
 };
 #endif
@@ -79,7 +84,7 @@ struct FlashDevice const FlashDevice  =  {
    ONCHIP,                     // Device Type
    0x02000000,                 // Device Start Address
    0x00040000,                 // Device Size (256kB)
-   256,                        // Programming Page Size
+   IAP_PAGE_SIZE,              // Programming Page Size
    0,                          // Reserved, must be 0
    0xFF,                       // Initial Content of Erased Memory
    300,                        // Program Page Timeout 300 mSec
@@ -97,15 +102,19 @@ struct FlashDevice const FlashDevice  =  {
    ONCHIP,                     // Device Type
    0x10000000,                 // Device Start Address
    0x00040000,                 // Device Size (256kB)
-   256,                        // Programming Page Size
+   IAP_PAGE_SIZE,              // Programming Page Size
    0,                          // Reserved, must be 0
    0xFF,                       // Initial Content of Erased Memory
    300,                        // Program Page Timeout 300 mSec
    3000,                       // Erase Sector Timeout 3000 mSec
 
 // Specify Size and Address of Sectors
+#ifdef IAP_ERASE_PAGE
+   IAP_ERASE_SIZE, 0x000000,   // Erase Page Size
+#else
    0x001000, 0x000000,         // Sector Size  4kB (24 Sectors)
    0x008000, 0x018000,         // Sector Size 32kB ( 5 Sectors)
+#endif
    SECTOR_END
 };
 #endif
@@ -116,7 +125,7 @@ struct FlashDevice const FlashDevice  =  {
    ONCHIP,                     // Device Type
    0x10000000,                 // Device Start Address
    0x00100000,                 // Device Size (1024kB)
-   256,                        // Programming Page Size
+   IAP_PAGE_SIZE,              // Programming Page Size
    0,                          // Reserved, must be 0
    0xFF,                       // Initial Content of Erased Memory
    300,                        // Program Page Timeout 300 mSec
@@ -139,7 +148,7 @@ struct FlashDevice const FlashDevice  =  {
    ONCHIP,                     // Device Type
    0x00000000,                 // Device Start Address
    0x00080000,                 // Device Size (512kB)
-   1024,                       // Programming Page Size
+   IAP_PAGE_SIZE,              // Programming Page Size
    0,                          // Reserved, must be 0
    0xFF,                       // Initial Content of Erased Memory
    100,                        // Program Page Timeout 100 mSec
@@ -159,7 +168,7 @@ struct FlashDevice const FlashDevice  =  {
    ONCHIP,                     // Device Type
    0x00000000,                 // Device Start Address
    0x00040000,                 // Device Size (256kB)
-   1024,                       // Programming Page Size
+   IAP_PAGE_SIZE,              // Programming Page Size
    0,                          // Reserved, must be 0
    0xFF,                       // Initial Content of Erased Memory
    100,                        // Program Page Timeout 100 mSec
@@ -179,7 +188,7 @@ struct FlashDevice const FlashDevice  =  {
    ONCHIP,                     // Device Type
    0x00000000,                 // Device Start Address
    0x00020000,                 // Device Size (128kB)
-   1024,                       // Programming Page Size
+   IAP_PAGE_SIZE,              // Programming Page Size
    0,                          // Reserved, must be 0
    0xFF,                       // Initial Content of Erased Memory
    100,                        // Program Page Timeout 100 mSec
@@ -199,7 +208,7 @@ struct FlashDevice const FlashDevice  =  {
    ONCHIP,                     // Device Type
    0x00000000,                 // Device Start Address
    0x00010000,                 // Device Size (64kB)
-   1024,                       // Programming Page Size
+   IAP_PAGE_SIZE,              // Programming Page Size
    0,                          // Reserved, must be 0
    0xFF,                       // Initial Content of Erased Memory
    100,                        // Program Page Timeout 100 mSec
@@ -218,7 +227,7 @@ struct FlashDevice const FlashDevice  =  {
    ONCHIP,                     // Device Type
    0x00000000,                 // Device Start Address
    0x00008000,                 // Device Size (32kB)
-   1024,                       // Programming Page Size
+   IAP_PAGE_SIZE,              // Programming Page Size
    0,                          // Reserved, must be 0
    0xFF,                       // Initial Content of Erased Memory
    100,                        // Program Page Timeout 100 mSec
@@ -15,6 +15,8 @@
  */
 
 #include "../FlashOS.H"        // FlashOS Structures
+#include "FlashDev.h"
+#include "../FlashCompare.h"
 
 // Memory Mapping Control
 #if defined(LPC11xx_32) || defined(LPC8xx_4) || defined(LPC11U68_256)
@@ -143,11 +145,22 @@ struct sIAP {                  // IAP Structure
 /* IAP Call */
 typedef void (*IAP_Entry) (unsigned long *cmd, unsigned long *stat);
 #if defined(LPC1549_256)
-  #define IAP_Call ((IAP_Entry) 0x03000205)
+  #define IAP_Rom ((IAP_Entry) 0x03000205)
 #elif defined(LPC4337_1024)
-  #define IAP_Call ((IAP_Entry) (*(volatile unsigned int *)(0x10400100)))
+  #define IAP_Rom ((IAP_Entry) (*(volatile unsigned int *)(0x10400100)))
 #else
-#define IAP_Call ((IAP_Entry) 0x1FFF1FF1)
+#define IAP_Rom ((IAP_Entry) 0x1FFF1FF1)
+#endif
+
+#ifdef FLASH_STATS
+/* The ROM waits for the flash controller, the whole call counts as busy */
+static void IAP_Call (unsigned long *cmd, unsigned long *stat) {
+  FLASH_STATS_BUSY_BEGIN();
+  IAP_Rom (cmd, stat);
+  FLASH_STATS_BUSY_END();
+}
+#else
+#define IAP_Call IAP_Rom
 #endif
 
 
@@ -189,6 +202,25 @@ unsigned long GetSecNum (unsigned long adr) {
   return (n);                                  // Sector Number
 }
 
+/*
+ * Get Copy RAM to Flash Size
+
+ *    Parameter:      sz:   Remaining Size (multiple of 256, 512 on LPC43xx)
+ *    Return Value:   Largest supported Byte Count not exceeding sz
+ */
+
+unsigned long GetCopySize (unsigned long sz) {
+
+  if ((IAP_PAGE_SIZE >= 4096) && (sz >= 4096)) return (4096);
+  if ((IAP_PAGE_SIZE >= 1024) && (sz >= 1024)) return (1024);
+  if ((IAP_PAGE_SIZE >=  512) && (sz >=  512)) return (512);
+#if defined(LPC4337_1024)
+  return (512);                                // IAP 51 takes no 256 Byte copies
+#else
+  return (256);
+#endif
+}
+
 #ifdef MBED
 
 /*
@@ -431,6 +463,21 @@ int EraseSector (unsigned long adr) {
   IAP_Call (&IAP.cmd, &IAP.stat);              // Call IAP Command
   if (IAP.stat) return (0xea5000 | IAP.stat);  // Command Failed
 
+#elif defined(IAP_ERASE_PAGE)
+
+  IAP.cmd    = 50;                             // Prepare Sector for Erase
+  IAP.par[0] = n;                              // Start Sector
+  IAP.par[1] = GetSecNum(adr + IAP_ERASE_SIZE - 1);  // End Sector
+  IAP_Call (&IAP.cmd, &IAP.stat);              // Call IAP Command
+  if (IAP.stat) return (1);                    // Command Failed
+
+  IAP.cmd    = 59;                             // Erase Page
+  IAP.par[0] = adr / IAP_HW_PAGE_SIZE;         // Start Page
+  IAP.par[1] = (adr + IAP_ERASE_SIZE - 1) / IAP_HW_PAGE_SIZE;  // End Page
+  IAP.par[2] = _CCLK;                          // CCLK in kHz
+  IAP_Call (&IAP.cmd, &IAP.stat);              // Call IAP Command
+  if (IAP.stat) return (1);                    // Command Failed
+
 #else
 
   IAP.cmd    = 50;                             // Prepare Sector for Erase
@@ -461,7 +508,7 @@ int EraseSector (unsigned long adr) {
  */
 
 int ProgramPage (unsigned long adr, unsigned long sz, unsigned char *buf) {
-  unsigned long n;
+  unsigned long n, cnt;
 
 #if NO_CRP != 0
   if (adr == 0) {
@@ -487,46 +534,141 @@ int ProgramPage (unsigned long adr, unsigned long sz, unsigned char *buf) {
   }
 #endif
 
-  n = GetSecNum(adr);                          // Get Sector Number
-
 #if defined(LPC4337_1024)
+  sz = (sz + 511) & ~511;                      // Adjust Size to 512 Byte Units
+#else
+  sz = (sz + 255) & ~255;                      // Adjust Size to 256 Byte Units
+#endif
 
-  IAP.cmd    = 50;                             // Prepare Sector for Write
-  IAP.par[0] = n;                              // Start Sector
-  IAP.par[1] = n;                              // End Sector
-  IAP.par[2] = FLASH_BANK(adr);                // Flash Bank
-  IAP_Call (&IAP.cmd, &IAP.stat);              // Call IAP Command
-  if (IAP.stat) return (0xea6000 | IAP.stat);  // Command Failed
+  while (sz) {
+    cnt = GetCopySize(sz);                     // Largest Copy RAM to Flash Size
+    n   = GetSecNum(adr);                      // Get Sector Number
 
-  IAP.cmd    = 51;                             // Copy RAM to Flash
-  IAP.par[0] = FLASH_ADDR(adr);                // Destination Flash Address
-  IAP.par[1] = (unsigned long)buf;             // Source RAM Address
-  IAP.par[2] = 512;                            // Fixed Page Size
-  IAP.par[3] = _CCLK;                          // CCLK in kHz
-  IAP_Call (&IAP.cmd, &IAP.stat);              // Call IAP Command
-  if (IAP.stat) return (0xea7000 | IAP.stat);  // Command Failed
+#if defined(LPC4337_1024)
+
+    IAP.cmd    = 50;                           // Prepare Sector for Write
+    IAP.par[0] = n;                            // Start Sector
+    IAP.par[1] = GetSecNum(adr + cnt - 1);     // End Sector
+    IAP.par[2] = FLASH_BANK(adr);              // Flash Bank
+    IAP_Call (&IAP.cmd, &IAP.stat);            // Call IAP Command
+    if (IAP.stat) return (0xea6000 | IAP.stat);  // Command Failed
+
+    IAP.cmd    = 51;                           // Copy RAM to Flash
+    IAP.par[0] = FLASH_ADDR(adr);              // Destination Flash Address
+    IAP.par[1] = (unsigned long)buf;           // Source RAM Address
+    IAP.par[2] = cnt;                          // Number of Bytes
+    IAP.par[3] = _CCLK;                        // CCLK in kHz
+    IAP_Call (&IAP.cmd, &IAP.stat);            // Call IAP Command
+    if (IAP.stat) return (0xea7000 | IAP.stat);  // Command Failed
 
 #else
 
-  IAP.cmd    = 50;                             // Prepare Sector for Write
-  IAP.par[0] = n;                              // Start Sector
-  IAP.par[1] = n;                              // End Sector
-  IAP_Call (&IAP.cmd, &IAP.stat);              // Call IAP Command
-  if (IAP.stat) return (1);                    // Command Failed
+    IAP.cmd    = 50;                           // Prepare Sector for Write
+    IAP.par[0] = n;                            // Start Sector
+    IAP.par[1] = GetSecNum(adr + cnt - 1);     // End Sector
+    IAP_Call (&IAP.cmd, &IAP.stat);            // Call IAP Command
+    if (IAP.stat) return (1);                  // Command Failed
 
-  IAP.cmd    = 51;                             // Copy RAM to Flash
-  IAP.par[0] = adr;                            // Destination Flash Address
-  IAP.par[1] = (unsigned long)buf;             // Source RAM Address
-#if defined(LPC11xx_32) || defined(LPC8xx_4) || defined(LPC1549_256) || defined(LPC11U68_256)
-  IAP.par[2] = 256;                            // Fixed Page Size
+    IAP.cmd    = 51;                           // Copy RAM to Flash
+    IAP.par[0] = adr;                          // Destination Flash Address
+    IAP.par[1] = (unsigned long)buf;           // Source RAM Address
+    IAP.par[2] = cnt;                          // Number of Bytes
+    IAP.par[3] = _CCLK;                        // CCLK in kHz
+    IAP_Call (&IAP.cmd, &IAP.stat);            // Call IAP Command
+    if (IAP.stat) return (1);                  // Command Failed
+
+#endif
+
+    adr += cnt;                                // Go to next Block
+    buf += cnt;
+    sz  -= cnt;
+  }
+
+return (0);                                  // Finished without Errors
+}
+
+
+/*
+ *  Blank Check Checks if Memory is Blank
+ *    Parameter:      adr:  Block Start Address
+ *                    sz:   Block Size (in bytes)
+ *                    pat:  Block Pattern
+ *    Return Value:   0 - OK,  1 - Failed
+ */
+
+int BlankCheck (unsigned long adr, unsigned long sz, unsigned char pat) {
+  unsigned long n, e;
+
+  if (sz == 0) return (0);
+
+  n = GetSecNum(adr);                          // Start Sector
+  e = GetSecNum(adr + sz - 1);                 // End Sector
+
+#if defined(LPC4337_1024)
+  if ((pat == 0xFF) && (FLASH_BANK(adr) == FLASH_BANK(adr + sz - 1))) {
+    IAP.cmd    = 53;                           // Blank Check Sector
+    IAP.par[0] = n;                            // Start Sector
+    IAP.par[1] = e;                            // End Sector
+    IAP.par[2] = FLASH_BANK(adr);              // Flash Bank
+    IAP_Call (&IAP.cmd, &IAP.stat);            // Call IAP Command
+    if (IAP.stat == 0) return (0);             // Whole Sectors Blank
+  }
+  adr = FLASH_ADDR(adr);
 #else
-  IAP.par[2] = 512;                            // Fixed Page Size
+  if (pat == 0xFF) {
+    IAP.cmd    = 53;                           // Blank Check Sector
+    IAP.par[0] = n;                            // Start Sector
+    IAP.par[1] = e;                            // End Sector
+    IAP_Call (&IAP.cmd, &IAP.stat);            // Call IAP Command
+    if (IAP.stat == 0) return (0);             // Whole Sectors Blank
+  }
 #endif
-  IAP.par[3] = _CCLK;                          // CCLK in kHz
-  IAP_Call (&IAP.cmd, &IAP.stat);              // Call IAP Command
-  if (IAP.stat) return (1);                    // Command Failed
 
+  // Sectors not blank outside the Block or other Pattern: check the Block itself
+  return ((CompareWords(adr, sz, 0, pat) == adr + sz) ? 0 : 1);
+}
+
+
+/*
+ *  Verify Flash Contents
+ *    Parameter:      adr:  Start Address
+ *                    sz:   Size (in bytes)
+ *                    buf:  Data
+ *    Return Value:   (adr+sz) - OK, Failed Address
+ */
+
+unsigned long Verify (unsigned long adr, unsigned long sz, unsigned char *buf) {
+  unsigned long n;
+  unsigned long fadr;
+
+#if SET_VALID_CODE != 0                        // Signature inserted by ProgramPage
+  if ((adr == 0) && (sz >= 0x20)) {
+    n = *((unsigned long *)(buf + 0x00)) +
+        *((unsigned long *)(buf + 0x04)) +
+        *((unsigned long *)(buf + 0x08)) +
+        *((unsigned long *)(buf + 0x0C)) +
+        *((unsigned long *)(buf + 0x10)) +
+        *((unsigned long *)(buf + 0x14)) +
+        *((unsigned long *)(buf + 0x18));
+    *((unsigned long *)(buf + 0x1C)) = 0 - n;  // Signature at Reserved Vector
+  }
 #endif
 
-return (0);                                  // Finished without Errors
+#if defined(LPC4337_1024)
+  fadr = FLASH_ADDR(adr);
+#else
+  fadr = adr;
+#endif
+
+  if ((((fadr | (unsigned long)buf | sz) & 3) == 0) && sz) {
+    IAP.cmd    = 56;                           // Compare
+    IAP.par[0] = fadr;                         // Flash Address
+    IAP.par[1] = (unsigned long)buf;           // RAM Address
+    IAP.par[2] = sz;                           // Number of Bytes
+    IAP_Call (&IAP.cmd, &IAP.stat);            // Call IAP Command
+    if (IAP.stat == 0) return (adr + sz);      // Contents Match
+  }
+
+  // Mismatch or unaligned Block: locate the first differing Byte
+  return (adr + (CompareWords(fadr, sz, buf, 0) - fadr));
 }
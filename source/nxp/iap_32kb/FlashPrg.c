@@ -15,6 +15,8 @@
  */
 
 #include "FlashOS.H"        // FlashOS Structures
+#include "FlashDev.h"
+#include "FlashCompare.h"
 
 // Memory Mapping Control
 #define MEMMAP     (*((volatile unsigned long *) 0x40048000))
@@ -43,7 +45,18 @@ struct sIAP {                  // IAP Structure
 
 /* IAP Call */
 typedef void (*IAP_Entry) (unsigned long *cmd, unsigned long *stat);
-#define IAP_Call ((IAP_Entry) 0x1FFF1FF1)
+#define IAP_Rom ((IAP_Entry) 0x1FFF1FF1)
+
+#ifdef FLASH_STATS
+/* The ROM waits for the flash controller, the whole call counts as busy */
+static void IAP_Call (unsigned long *cmd, unsigned long *stat) {
+  FLASH_STATS_BUSY_BEGIN();
+  IAP_Rom (cmd, stat);
+  FLASH_STATS_BUSY_END();
+}
+#else
+#define IAP_Call IAP_Rom
+#endif
 
 
 /*
@@ -58,6 +71,21 @@ unsigned long GetSecNum (unsigned long adr)
     return (adr >> 12);
 }
 
+/*
+ * Get Copy RAM to Flash Size
+
+ *    Parameter:      sz:   Remaining Size (multiple of 256)
+ *    Return Value:   Largest supported Byte Count not exceeding sz
+ */
+
+unsigned long GetCopySize (unsigned long sz)
+{
+    if ((IAP_PAGE_SIZE >= 4096) && (sz >= 4096)) return (4096);
+    if ((IAP_PAGE_SIZE >= 1024) && (sz >= 1024)) return (1024);
+    if ((IAP_PAGE_SIZE >=  512) && (sz >=  512)) return (512);
+    return (256);
+}
+
 /*
  *  Initialize Flash Programming Functions
  *    Parameter:      adr:  Device Base Address
@@ -162,8 +190,7 @@ int EraseSector (unsigned long adr)
 
 int ProgramPage (unsigned long adr, unsigned long sz, unsigned char *buf)
 {
-#warning why does not it use sz?
-    unsigned long n;
+    unsigned long n, cnt;
 
     if (adr == 0) {                              // Check for Vector Table
         n = *((unsigned long *)(buf + 0x00)) +
@@ -176,25 +203,102 @@ int ProgramPage (unsigned long adr, unsigned long sz, unsigned char *buf)
         *((unsigned long *)(buf + 0x1C)) = 0 - n;  // Signature at Reserved Vector
     }
 
-    n = GetSecNum(adr);                          // Get Sector Number
+    sz = (sz + 255) & ~255;                      // Adjust Size to 256 Byte Units
+
+    while (sz) {
+        cnt = GetCopySize(sz);                   // Largest Copy RAM to Flash Size
+        n   = GetSecNum(adr);                    // Get Sector Number
+
+        IAP.cmd    = 50;                         // Prepare Sector for Write
+        IAP.par[0] = n;                          // Start Sector
+        IAP.par[1] = GetSecNum(adr + cnt - 1);   // End Sector
+        IAP_Call (&IAP.cmd, &IAP.stat);          // Call IAP Command
+        if (IAP.stat) {                          // Command Failed
+            return (1);
+        }
+
+        IAP.cmd    = 51;                         // Copy RAM to Flash
+        IAP.par[0] = adr;                        // Destination Flash Address
+        IAP.par[1] = (unsigned long)buf;         // Source RAM Address
+        IAP.par[2] = cnt;                        // Number of Bytes
+        IAP.par[3] = _CCLK;                      // CCLK in kHz
+        IAP_Call (&IAP.cmd, &IAP.stat);          // Call IAP Command
+        if (IAP.stat) {                          // Command Failed
+            return (1);
+        }
+
+        adr += cnt;                              // Go to next Block
+        buf += cnt;
+        sz  -= cnt;
+    }
 
-    IAP.cmd    = 50;                             // Prepare Sector for Write
-    IAP.par[0] = n;                              // Start Sector
-    IAP.par[1] = n;                              // End Sector
-    IAP_Call (&IAP.cmd, &IAP.stat);              // Call IAP Command
-    if (IAP.stat) {                              // Command Failed
-        return (1);
+    return (0);                                  // Finished without Errors
+}
+
+
+/*
+ *  Blank Check Checks if Memory is Blank
+ *    Parameter:      adr:  Block Start Address
+ *                    sz:   Block Size (in bytes)
+ *                    pat:  Block Pattern
+ *    Return Value:   0 - OK,  1 - Failed
+ */
+
+int BlankCheck (unsigned long adr, unsigned long sz, unsigned char pat)
+{
+    if (sz == 0) {
+        return (0);
     }
 
-    IAP.cmd    = 51;                             // Copy RAM to Flash
-    IAP.par[0] = adr;                            // Destination Flash Address
-    IAP.par[1] = (unsigned long)buf;             // Source RAM Address
-    IAP.par[2] = 256;                            // Fixed Page Size
-    IAP.par[3] = _CCLK;                          // CCLK in kHz
-    IAP_Call (&IAP.cmd, &IAP.stat);              // Call IAP Command
-    if (IAP.stat) {                              // Command Failed
-        return (1);
+    if (pat == 0xFF) {
+        IAP.cmd    = 53;                         // Blank Check Sector
+        IAP.par[0] = GetSecNum(adr);             // Start Sector
+        IAP.par[1] = GetSecNum(adr + sz - 1);    // End Sector
+        IAP_Call (&IAP.cmd, &IAP.stat);          // Call IAP Command
+        if (IAP.stat == 0) {                     // Whole Sectors Blank
+            return (0);
+        }
     }
 
-    return (0);                                  // Finished without Errors
+    // Sectors not blank outside the Block or other Pattern: check the Block itself
+    return ((CompareWords(adr, sz, 0, pat) == adr + sz) ? 0 : 1);
+}
+
+
+/*
+ *  Verify Flash Contents
+ *    Parameter:      adr:  Start Address
+ *                    sz:   Size (in bytes)
+ *                    buf:  Data
+ *    Return Value:   (adr+sz) - OK, Failed Address
+ */
+
+unsigned long Verify (unsigned long adr, unsigned long sz, unsigned char *buf)
+{
+    unsigned long n;
+
+    if ((adr == 0) && (sz >= 0x20)) {            // Signature inserted by ProgramPage
+        n = *((unsigned long *)(buf + 0x00)) +
+            *((unsigned long *)(buf + 0x04)) +
+            *((unsigned long *)(buf + 0x08)) +
+            *((unsigned long *)(buf + 0x0C)) +
+            *((unsigned long *)(buf + 0x10)) +
+            *((unsigned long *)(buf + 0x14)) +
+            *((unsigned long *)(buf + 0x18));
+        *((unsigned long *)(buf + 0x1C)) = 0 - n;  // Signature at Reserved Vector
+    }
+
+    if ((((adr | (unsigned long)buf | sz) & 3) == 0) && sz) {
+        IAP.cmd    = 56;                         // Compare
+        IAP.par[0] = adr;                        // Flash Address
+        IAP.par[1] = (unsigned long)buf;         // RAM Address
+        IAP.par[2] = sz;                         // Number of Bytes
+        IAP_Call (&IAP.cmd, &IAP.stat);          // Call IAP Command
+        if (IAP.stat == 0) {                     // Contents Match
+            return (adr + sz);
+        }
+    }
+
+    // Mismatch or unaligned Block: locate the first differing Byte
+    return (CompareWords(adr, sz, buf, 0));
 }
@@ -15,6 +15,7 @@
  */
 
 #include "FlashOS.H"         // FlashOS Structures
+#include "FlashDev.h"
 
 #define FLASH_DRV_VERS (0x0100+VERS)   // Driver Version, do not modify!
 
@@ -24,7 +25,7 @@ struct FlashDevice const FlashDevice  =  {
     ONCHIP,                     // Device Type
     0x00000000,                 // Device Start Address
     0x00080000,                 // Device Size (512kB)
-    1024,                       // Programming Page Size
+    IAP_PAGE_SIZE,              // Programming Page Size
     0,                          // Reserved, must be 0
     0xFF,                       // Initial Content of Erased Memory
     300,                        // Program Page Timeout 300 mSec
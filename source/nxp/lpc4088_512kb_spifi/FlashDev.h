@@ -0,0 +1,25 @@
+/* CMSIS-DAP Interface Firmware
+ * Copyright (c) 2009-2013 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef FLASHDEV_H
+#define FLASHDEV_H
+
+// Programming Page Size, also the largest Copy RAM to Flash (IAP 51) Byte Count
+// used by ProgramPage. Valid values are 256, 512, 1024 and 4096.
+#ifndef IAP_PAGE_SIZE
+  #define IAP_PAGE_SIZE           4096
+#endif
+
+#endif
@@ -15,6 +15,8 @@
  */
 
 #include "FlashOS.H"        // FlashOS Structures
+#include "FlashDev.h"
+#include "FlashCompare.h"
 
 // Memory Mapping Control
 #define MEMMAP   (*((volatile unsigned char *) 0x400FC040))
@@ -61,6 +63,21 @@ unsigned long GetSecNum (unsigned long adr)
     return (n);                                  // Sector Number
 }
 
+/*
+ * Get Copy RAM to Flash Size
+
+ *    Parameter:      sz:   Remaining Size (multiple of 256)
+ *    Return Value:   Largest supported Byte Count not exceeding sz
+ */
+
+unsigned long GetCopySize (unsigned long sz)
+{
+    if ((IAP_PAGE_SIZE >= 4096) && (sz >= 4096)) return (4096);
+    if ((IAP_PAGE_SIZE >= 1024) && (sz >= 1024)) return (1024);
+    if ((IAP_PAGE_SIZE >=  512) && (sz >=  512)) return (512);
+    return (256);
+}
+
 #define USE_SPIFI
 #ifdef USE_SPIFI
 
@@ -102,6 +119,11 @@ static void PINSEL_ConfigPin( uint8_t portnum, uint8_t pinnum, uint8_t funcnum)
 	  *pPIN |= funcnum;
 }
 
+/*
+ *  Board LEDs show progress when SPIFI_LED is defined, they are
+ *  left alone otherwise to keep the programming loop lean.
+ */
+#ifdef SPIFI_LED
 #define LPC_GPIO0_DIR      (*((volatile unsigned long *) 0x20098000))
 #define LPC_GPIO0_SET      (*((volatile unsigned long *) 0x20098018))
 #define LPC_GPIO0_CLR      (*((volatile unsigned long *) 0x2009801C))
@@ -130,17 +152,96 @@ static void PINSEL_ConfigPin( uint8_t portnum, uint8_t pinnum, uint8_t funcnum)
    LPC_GPIO1_DIR |= (1<<13) | (1<<18); \
    LPC_GPIO2_DIR |= (1<<19); \
 } while(0)
+#else
+#define LED1_OFF
+#define LED1_ON
+#define LED2_OFF
+#define LED2_ON
+#define LED_INIT
+#endif
 
 #define QSPI_FLASH_ERASE_BLOCK_SIZE  4096
 
+/* Erased with a single command when a write covers the whole block, or once
+   the sequential writes of the session have filled a whole block before it */
+#ifndef QSPI_FLASH_LARGE_BLOCK_SIZE
+#define QSPI_FLASH_LARGE_BLOCK_SIZE  (64 * 1024)
+#endif
+
+static uint32_t erased_start, erased_end;  /* SPIFI range erased this session */
+
+/*
+ *  Get memory mapped SPIFI address for an algorithm address, see ProgramPage
+ */
+static unsigned long SpifiMemAddr(unsigned long adr)
+{
+    if (adr >= 0x28000000) {
+        return adr;
+    }
+    return 0x28000000 + (adr - 0x80000);
+}
+
+/*
+ *  Erase the SPIFI erase blocks starting inside a write of sz bytes at adr,
+ *  skipping blocks already erased in this session.
+ *    Parameter:      adr:  Write Start Offset
+ *                    sz:   Write Size
+ *    Return Value:   0 - OK,  1 - Failed
+ */
+static int eraseSpifi(uint32_t adr, uint32_t sz)
+{
+    uint32_t blk = (adr + QSPI_FLASH_ERASE_BLOCK_SIZE - 1) & ~(QSPI_FLASH_ERASE_BLOCK_SIZE - 1);
+    uint32_t len;
+    int rc;
+
+    while (blk < adr + sz) {
+        if ((blk >= erased_start) && (blk < erased_end)) {
+            blk = erased_end;
+            continue;
+        }
+
+        /* A large block is erased ahead when the erased range continues
+           here and already spans a large block, i.e. an image is streamed */
+        len = QSPI_FLASH_ERASE_BLOCK_SIZE;
+        if (((blk % QSPI_FLASH_LARGE_BLOCK_SIZE) == 0) &&
+            ((adr + sz >= blk + QSPI_FLASH_LARGE_BLOCK_SIZE) ||
+             ((blk == erased_end) && (blk - erased_start >= QSPI_FLASH_LARGE_BLOCK_SIZE)))) {
+            len = QSPI_FLASH_LARGE_BLOCK_SIZE;
+        }
+
+        opers.options = S_NO_VERIFY;
+        opers.length = len;
+        opers.dest = (char*)blk;
+        opers.scratch = 0;
+        opers.protect = 0;
+        FLASH_STATS_BUSY_BEGIN();
+        rc = spifi->spifi_erase(&obj, &opers);
+        FLASH_STATS_BUSY_END();
+        if (rc) {
+            erased_start = erased_end = 0;
+            return 1;
+        }
+
+        if (blk != erased_end) {
+            erased_start = blk;
+        }
+        erased_end = blk + len;
+        blk += len;
+    }
+    return (0);
+}
+
 /*
  *  Program Page in SPIFI Memory. The adr parameter should be offset from
  *  the start of the SPIFI memory (0x28000000), i.e. the first write should
  *  have adr=0.
- *  SPIFI is programmed in blocks of 256bytes. SPIFI does not have to be
- *  erased in advace as all programming calls are made with a scratch buffer
- *  allowing the SPIFI ROM driver to erase as needed. The scratch buffer must
- *  be large enough to hold an entire erase sector.
+ *  Every erase block starting inside the page is erased first (once per
+ *  session), so pages of any size are programmed with a single call without
+ *  a scratch buffer. Large blocks are erased with a single command when the
+ *  page covers them or when the pages so far were written sequentially over
+ *  at least one whole large block; data behind the end of such an image
+ *  inside its last large block is not preserved.
+ *  Data is checked by Verify unless SPIFI_VERIFY_PROG is defined.
  *
  *    Parameter:      adr:  Page Start Address
  *                    sz:   Page Size
@@ -149,10 +250,9 @@ static void PINSEL_ConfigPin( uint8_t portnum, uint8_t pinnum, uint8_t funcnum)
  */
 static int saveInSpifi(uint32_t adr, uint32_t sz, uint8_t* buf)
 {
-    uint32_t left = sz;
-    uint32_t off = 0;
     int rc;
 
+#ifdef SPIFI_LED
     static int led1toggle = 1;
     led1toggle++;
     if (led1toggle & 1) {
@@ -160,41 +260,30 @@ static int saveInSpifi(uint32_t adr, uint32_t sz, uint8_t* buf)
     } else {
         LED1_OFF;
     }
+#endif
 
-    if ((adr % QSPI_FLASH_ERASE_BLOCK_SIZE) == 0) {
-        /* Want to write at the start of an erase block.
-           To speed up things, erase the entire block now. */
-
-        opers.options = S_NO_VERIFY;
-        opers.length = QSPI_FLASH_ERASE_BLOCK_SIZE;
-        opers.dest = (char*)adr;
-        opers.scratch = 0;
-        opers.protect = 0;
-        rc = spifi->spifi_erase(&obj, &opers);
-        if (rc) {
-            return 1;
-        }
+    if (eraseSpifi(adr, sz)) {
+        return 1;
     }
 
     /* Now that we know that the SPIFI is erased for all offsets
-       inside this erase block, it is save to set S_CALLER_ERASE
+       inside this page, it is save to set S_CALLER_ERASE
        i.e. tell spifi_program() that erasing is not needed.
        Without erasing there is no need for a scratch buffer. */
+#ifdef SPIFI_VERIFY_PROG
     opers.options = S_VERIFY_PROG | S_CALLER_ERASE;
+#else
+    opers.options = S_CALLER_ERASE;
+#endif
     opers.scratch = 0;
     opers.protect = 0;
-
-    while (left > 0) {
-        uint32_t chunk = (left > 256) ? 256 : left;
-
-        opers.length = chunk;
-        opers.dest = (char *)(adr + off);
-        rc = spifi->spifi_program(&obj, (char*)(buf+off), &opers);
-        if (rc) {
-            return 1;
-        }
-        off += chunk;
-        left -= chunk;
+    opers.length = sz;
+    opers.dest = (char *)adr;
+    FLASH_STATS_BUSY_BEGIN();
+    rc = spifi->spifi_program(&obj, (char*)buf, &opers);
+    FLASH_STATS_BUSY_END();
+    if (rc) {
+        return 1;
     }
     return (0);
 }
@@ -238,6 +327,9 @@ int Init (unsigned long adr, unsigned long clk, unsigned long fnc)
     /* Get SPIFI API table pointer */
     spifi = ROM_DRIVERS_PTR->pSPIFID;
 
+    /* SPIFI is only erased while programming, start over for each pass */
+    erased_start = erased_end = 0;
+
     {
         uint32_t spifi_clk_mhz = (_CCLK/1000)/(SPIFICLKSEL & 0x1f);
         int rc;
@@ -352,10 +444,10 @@ int EraseSector (unsigned long adr)
 
 int ProgramPage (unsigned long adr, unsigned long sz, unsigned char *buf)
 {
-#warning why does not it use sz?
-    unsigned long n;
+    unsigned long n, cnt;
 
 #ifdef USE_SPIFI
+#ifdef SPIFI_LED
     static int led2toggle = 0;
     led2toggle++;
     if (led2toggle & 1) {
@@ -363,6 +455,7 @@ int ProgramPage (unsigned long adr, unsigned long sz, unsigned char *buf)
     } else {
         LED2_OFF;
     }
+#endif
     if (adr >= 0x28000000) {
         /* Address is in the SPIFI address space. SPIFI is only erased when needed
            so this call is ignored. */
@@ -387,25 +480,155 @@ int ProgramPage (unsigned long adr, unsigned long sz, unsigned char *buf)
         *((unsigned long *)(buf + 0x1C)) = 0 - n;  // Signature at Reserved Vector
     }
 
-    n = GetSecNum(adr);                          // Get Sector Number
+    sz = (sz + 255) & ~255;                      // Adjust Size to 256 Byte Units
 
-    IAP.cmd    = 50;                             // Prepare Sector for Write
-    IAP.par[0] = n;                              // Start Sector
-    IAP.par[1] = n;                              // End Sector
-    IAP_Call (&IAP.cmd, &IAP.stat);              // Call IAP Command
-    if (IAP.stat) {                              // Command Failed
-        return (1);
-    }
+    while (sz) {
+        cnt = GetCopySize(sz);                   // Largest Copy RAM to Flash Size
+        n   = GetSecNum(adr);                    // Get Sector Number
 
-    IAP.cmd    = 51;                             // Copy RAM to Flash
-    IAP.par[0] = adr;                            // Destination Flash Address
-    IAP.par[1] = (unsigned long)buf;             // Source RAM Address
-    IAP.par[2] = 512;                            // Fixed Page Size
-    IAP.par[3] = _CCLK;                          // CCLK in kHz
-    IAP_Call (&IAP.cmd, &IAP.stat);              // Call IAP Command
-    if (IAP.stat) {                              // Command Failed
-        return (1);
+        IAP.cmd    = 50;                         // Prepare Sector for Write
+        IAP.par[0] = n;                          // Start Sector
+        IAP.par[1] = GetSecNum(adr + cnt - 1);   // End Sector
+        IAP_Call (&IAP.cmd, &IAP.stat);          // Call IAP Command
+        if (IAP.stat) {                          // Command Failed
+            return (1);
+        }
+
+        IAP.cmd    = 51;                         // Copy RAM to Flash
+        IAP.par[0] = adr;                        // Destination Flash Address
+        IAP.par[1] = (unsigned long)buf;         // Source RAM Address
+        IAP.par[2] = cnt;                        // Number of Bytes
+        IAP.par[3] = _CCLK;                      // CCLK in kHz
+        IAP_Call (&IAP.cmd, &IAP.stat);          // Call IAP Command
+        if (IAP.stat) {                          // Command Failed
+            return (1);
+        }
+
+        adr += cnt;                              // Go to next Block
+        buf += cnt;
+        sz  -= cnt;
     }
 
     return (0);                                  // Finished without Errors
 }
+
+
+/*
+ *  Blank Check Checks if Memory is Blank
+ *    Parameter:      adr:  Block Start Address
+ *                    sz:   Block Size (in bytes)
+ *                    pat:  Block Pattern
+ *    Return Value:   0 - OK,  1 - Failed
+ */
+
+int BlankCheck (unsigned long adr, unsigned long sz, unsigned char pat)
+{
+    if (sz == 0) {
+        return (0);
+    }
+
+#ifdef USE_SPIFI
+    if (adr >= 0x80000) {                        // SPIFI, see ProgramPage
+        adr = SpifiMemAddr(adr);
+        spifi->set_mem_mode(&obj);               // Read through the SPIFI window
+        return ((CompareWords(adr, sz, 0, pat) == adr + sz) ? 0 : 1);
+    }
+#endif
+
+    if (pat == 0xFF) {
+        IAP.cmd    = 53;                         // Blank Check Sector
+        IAP.par[0] = GetSecNum(adr);             // Start Sector
+        IAP.par[1] = GetSecNum(adr + sz - 1);    // End Sector
+        IAP_Call (&IAP.cmd, &IAP.stat);          // Call IAP Command
+        if (IAP.stat == 0) {                     // Whole Sectors Blank
+            return (0);
+        }
+    }
+
+    // Sectors not blank outside the Block or other Pattern: check the Block itself
+    return ((CompareWords(adr, sz, 0, pat) == adr + sz) ? 0 : 1);
+}
+
+
+/*
+ *  Verify Flash Contents
+ *    Parameter:      adr:  Start Address
+ *                    sz:   Size (in bytes)
+ *                    buf:  Data
+ *    Return Value:   (adr+sz) - OK, Failed Address
+ */
+
+unsigned long Verify (unsigned long adr, unsigned long sz, unsigned char *buf)
+{
+    unsigned long n;
+
+#ifdef USE_SPIFI
+    if (adr >= 0x80000) {                        // SPIFI, see ProgramPage
+        n = SpifiMemAddr(adr);
+        spifi->set_mem_mode(&obj);               // Read through the SPIFI window
+        return (adr + (CompareWords(n, sz, buf, 0) - n));
+    }
+#endif
+
+    if ((adr == 0) && (sz >= 0x20)) {            // Signature inserted by ProgramPage
+        n = *((unsigned long *)(buf + 0x00)) +
+            *((unsigned long *)(buf + 0x04)) +
+            *((unsigned long *)(buf + 0x08)) +
+            *((unsigned long *)(buf + 0x0C)) +
+            *((unsigned long *)(buf + 0x10)) +
+            *((unsigned long *)(buf + 0x14)) +
+            *((unsigned long *)(buf + 0x18));
+        *((unsigned long *)(buf + 0x1C)) = 0 - n;  // Signature at Reserved Vector
+    }
+
+    if ((((adr | (unsigned long)buf | sz) & 3) == 0) && sz) {
+        IAP.cmd    = 56;                         // Compare
+        IAP.par[0] = adr;                        // Flash Address
+        IAP.par[1] = (unsigned long)buf;         // RAM Address
+        IAP.par[2] = sz;                         // Number of Bytes
+        IAP_Call (&IAP.cmd, &IAP.stat);          // Call IAP Command
+        if (IAP.stat == 0) {                     // Contents Match
+            return (adr + sz);
+        }
+    }
+
+    // Mismatch or unaligned Block: locate the first differing Byte
+    return (CompareWords(adr, sz, buf, 0));
+}
+
+
+/*
+ *  Calculate CRC-32 (IEEE 802.3) of Flash Contents, SPIFI is read through
+ *  the memory mapped window so the host can check an image in one call
+ *    Parameter:      adr:  Start Address
+ *                    sz:   Size (in bytes)
+ *    Return Value:   CRC-32 of the Block
+ */
+
+unsigned long Crc32 (unsigned long adr, unsigned long sz)
+{
+    static const unsigned long tab[16] = {       // CRC-32 (0xEDB88320) per Nibble
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+        0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+        0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    unsigned long crc = 0xFFFFFFFF;
+    unsigned char *p;
+
+#ifdef USE_SPIFI
+    if (adr >= 0x80000) {                        // SPIFI, see ProgramPage
+        adr = SpifiMemAddr(adr);
+        spifi->set_mem_mode(&obj);
+    }
+#endif
+
+    p = (unsigned char *)adr;
+    while (sz--) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ tab[crc & 0x0F];
+        crc = (crc >> 4) ^ tab[crc & 0x0F];
+    }
+
+    return (~crc);
+}
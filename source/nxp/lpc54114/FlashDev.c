@@ -30,6 +30,10 @@ struct FlashDevice const FlashDevice = {
     0xFF,                       // Initial Content of Erased Memory
     300,                        // Program Page Timeout 300 mSec
     3000,                       // Erase Sector Timeout 3000 mSec
+#ifdef IAP_ERASE_PAGE
+    {{FSL_FEATURE_SYSCON_FLASH_PAGE_SIZE_BYTES, 0x000000},  // Erase Page Size 256B
+#else
     {{0x008000, 0x000000},      // Sector Size  32kB
+#endif
     {SECTOR_END}}
 };
@@ -16,6 +16,7 @@
 
 #include "FlashOS.H"        // FlashOS Structures
 #include "fsl_flashiap.h"
+#include "FlashCompare.h"
 #include "fsl_power.h"
 #include "string.h"
 
@@ -23,8 +24,113 @@
 
 #define MEMMAP   (*((volatile unsigned long *) 0x40000000))
 
+/* Core clock handed to the IAP calls, raised while IAP_CLK_BOOST runs from the PLL */
+static uint32_t core_clk = CORE_CLK;
+
+#ifdef IAP_CLK_BOOST
+/*
+ * POWER_SetVoltageForFreq() lives in the SDK power library, linked in by the
+ * lpc54608_boost project (records/projects/nxp/common/lpc54608_clk_boost.yaml).
+ */
+
+/* System PLL from FRO12M: 12MHz * 30 * 2 / 4 = 180MHz (SDK BOARD_BootClockPLL180M) */
+#define PLL_CLK    180000000
+#define PLL_CTRL   (SYSCON_SYSPLLCTRL_SELI(32U) | SYSCON_SYSPLLCTRL_SELP(16U) | SYSCON_SYSPLLCTRL_SELR(0U))
+#define PLL_NDEC   SYSCON_SYSPLLNDEC_NDEC(770U)
+#define PLL_PDEC   SYSCON_SYSPLLPDEC_PDEC(98U)
+#define PLL_MDEC   SYSCON_SYSPLLMDEC_MDEC(8191U)
+#define PLL_FLASHTIM  8U                         /* 9 system clocks up to 180MHz */
+
+static struct {
+    uint32_t pdruncfg0;
+    uint32_t mainclksela;
+    uint32_t mainclkselb;
+    uint32_t syspllclksel;
+    uint32_t syspllctrl;
+    uint32_t syspllndec;
+    uint32_t syspllpdec;
+    uint32_t syspllmdec;
+    uint32_t flashcfg;
+    uint32_t ahbclkdiv;
+    uint32_t froctrl;
+} clk_saved;
+
+static void ClockSave(void)
+{
+    clk_saved.pdruncfg0    = SYSCON->PDRUNCFG[0];
+    clk_saved.mainclksela  = SYSCON->MAINCLKSELA;
+    clk_saved.mainclkselb  = SYSCON->MAINCLKSELB;
+    clk_saved.syspllclksel = SYSCON->SYSPLLCLKSEL;
+    clk_saved.syspllctrl   = SYSCON->SYSPLLCTRL;
+    clk_saved.syspllndec   = SYSCON->SYSPLLNDEC;
+    clk_saved.syspllpdec   = SYSCON->SYSPLLPDEC;
+    clk_saved.syspllmdec   = SYSCON->SYSPLLMDEC;
+    clk_saved.flashcfg     = SYSCON->FLASHCFG;
+    clk_saved.ahbclkdiv    = SYSCON->AHBCLKDIV;
+    clk_saved.froctrl      = SYSCON->FROCTRL;
+}
+
+static void ClockBoost(void)
+{
+    POWER_SetVoltageForFreq(PLL_CLK);                       /*!< Voltage and wait states before raising the clock */
+    SYSCON->FLASHCFG = (SYSCON->FLASHCFG & ~SYSCON_FLASHCFG_FLASHTIM_MASK) | SYSCON_FLASHCFG_FLASHTIM(PLL_FLASHTIM);
+
+    POWER_EnablePD(kPDRUNCFG_PD_SYS_PLL0);                  /*!< PLL off while it is reconfigured */
+    SYSCON->SYSPLLCLKSEL = SYSCON_SYSPLLCLKSEL_SEL(0U);      /*!< PLL input FRO12M */
+    SYSCON->SYSPLLCTRL = PLL_CTRL;
+    SYSCON->SYSPLLNDEC = PLL_NDEC;
+    SYSCON->SYSPLLNDEC = PLL_NDEC | SYSCON_SYSPLLNDEC_NREQ_MASK;
+    SYSCON->SYSPLLPDEC = PLL_PDEC;
+    SYSCON->SYSPLLPDEC = PLL_PDEC | SYSCON_SYSPLLPDEC_PREQ_MASK;
+    SYSCON->SYSPLLMDEC = PLL_MDEC;
+    SYSCON->SYSPLLMDEC = PLL_MDEC | SYSCON_SYSPLLMDEC_MREQ_MASK;
+    POWER_DisablePD(kPDRUNCFG_PD_SYS_PLL0);
+    while ((SYSCON->SYSPLLSTAT & SYSCON_SYSPLLSTAT_LOCK_MASK) == 0U)
+    {
+    }
+
+    SYSCON->MAINCLKSELB = SYSCON_MAINCLKSELB_SEL(2U);        /*!< Main clock from System PLL */
+    core_clk = PLL_CLK;
+}
+
+static void ClockRestore(void)
+{
+    SYSCON->MAINCLKSELB = 0U;                               /*!< Back to FRO12M before touching the PLL */
+    SYSCON->MAINCLKSELA = 0U;
+    POWER_EnablePD(kPDRUNCFG_PD_SYS_PLL0);
+
+    SYSCON->SYSPLLCLKSEL = clk_saved.syspllclksel;
+    SYSCON->SYSPLLCTRL   = clk_saved.syspllctrl;
+    SYSCON->SYSPLLNDEC   = clk_saved.syspllndec | SYSCON_SYSPLLNDEC_NREQ_MASK;
+    SYSCON->SYSPLLPDEC   = clk_saved.syspllpdec | SYSCON_SYSPLLPDEC_PREQ_MASK;
+    SYSCON->SYSPLLMDEC = clk_saved.syspllmdec | SYSCON_SYSPLLMDEC_MREQ_MASK;
+    if ((clk_saved.pdruncfg0 & (1UL << (kPDRUNCFG_PD_SYS_PLL0 & 0xffU))) == 0U)
+    {
+        POWER_DisablePD(kPDRUNCFG_PD_SYS_PLL0);
+        while ((SYSCON->SYSPLLSTAT & SYSCON_SYSPLLSTAT_LOCK_MASK) == 0U)
+        {
+        }
+    }
+
+    SYSCON->FROCTRL     = (SYSCON->FROCTRL & ~SYSCON_FROCTRL_HSPDCLK_MASK) | (clk_saved.froctrl & SYSCON_FROCTRL_HSPDCLK_MASK);
+    SYSCON->FLASHCFG    = clk_saved.flashcfg;
+    SYSCON->AHBCLKDIV   = clk_saved.ahbclkdiv;
+    SYSCON->MAINCLKSELA = clk_saved.mainclksela;
+    SYSCON->MAINCLKSELB = clk_saved.mainclkselb;
+    if ((clk_saved.mainclksela | clk_saved.mainclkselb) == 0U)
+    {
+        POWER_SetVoltageForFreq(CORE_CLK);                  /*!< Voltage only lowered when back on FRO12M */
+    }
+    core_clk = CORE_CLK;
+}
+#endif
+
 uint32_t Init(uint32_t adr, uint32_t clk, uint32_t fnc)
 {
+#ifdef IAP_CLK_BOOST
+    ClockSave();
+#endif
+
     /*!< Set up the clock sources */
     /*!< Set up FRO */
     POWER_DisablePD(kPDRUNCFG_PD_FRO_EN);                   /*!< Ensure FRO is on  */
@@ -44,6 +150,10 @@ uint32_t Init(uint32_t adr, uint32_t clk, uint32_t fnc)
     /* User Flash mode */
     MEMMAP = 0x02;
 
+#ifdef IAP_CLK_BOOST
+    ClockBoost();
+#endif
+
     return (0);
 }
 
@@ -55,6 +165,9 @@ uint32_t Init(uint32_t adr, uint32_t clk, uint32_t fnc)
  */
 uint32_t UnInit(uint32_t fnc)
 {
+#ifdef IAP_CLK_BOOST
+    ClockRestore();
+#endif
     return (0);
 }
 
@@ -67,7 +180,7 @@ uint32_t EraseChip(void)
     int status = FLASHIAP_PrepareSectorForWrite(0, 15);
     if (status == kStatus_Success)
     {
-        status = FLASHIAP_EraseSector(0, 15, CORE_CLK);
+        status = FLASHIAP_EraseSector(0, 15, core_clk);
     }
     return status;
 }
@@ -87,7 +200,12 @@ uint32_t EraseSector(uint32_t adr)
     status = FLASHIAP_PrepareSectorForWrite(n, n);
     if (status == kStatus_Success)
     {
-        status = FLASHIAP_EraseSector(n, n, CORE_CLK);
+#ifdef IAP_ERASE_PAGE
+        n = adr / FSL_FEATURE_SYSCON_FLASH_PAGE_SIZE_BYTES;  // Get Page Number
+        status = FLASHIAP_ErasePage(n, n, core_clk);
+#else
+        status = FLASHIAP_EraseSector(n, n, core_clk);
+#endif
     }
     return status;
 }
@@ -120,7 +238,63 @@ uint32_t ProgramPage(uint32_t adr, uint32_t sz, uint32_t *buf)
     status = FLASHIAP_PrepareSectorForWrite(n, n);
     if (status == kStatus_Success)
     {
-        status = FLASHIAP_CopyRamToFlash(adr, buf, FSL_FEATURE_SYSCON_FLASH_PAGE_SIZE_BYTES, CORE_CLK);
+        status = FLASHIAP_CopyRamToFlash(adr, buf, FSL_FEATURE_SYSCON_FLASH_PAGE_SIZE_BYTES, core_clk);
     }
     return status;
 }
+
+/*
+ *  Blank Check Checks if Memory is Blank
+ *    Parameter:      adr:  Block Start Address
+ *                    sz:   Block Size (in bytes)
+ *                    pat:  Block Pattern
+ *    Return Value:   0 - OK,  1 - Failed
+ */
+uint32_t BlankCheck(uint32_t adr, uint32_t sz, uint8_t pat)
+{
+    if (sz == 0)
+    {
+        return (0);
+    }
+
+    if (pat == 0xFF)
+    {
+        if (FLASHIAP_BlankCheckSector(adr / FSL_FEATURE_SYSCON_FLASH_SECTOR_SIZE_BYTES,
+                                      (adr + sz - 1) / FSL_FEATURE_SYSCON_FLASH_SECTOR_SIZE_BYTES) == kStatus_Success)
+        {
+            return (0);
+        }
+    }
+
+    /* Sectors not blank outside the block or other pattern: check the block itself */
+    return (CompareWords(adr, sz, NULL, pat) == adr + sz) ? 0 : 1;
+}
+
+/*
+ *  Verify Flash Contents
+ *    Parameter:      adr:  Start Address
+ *                    sz:   Size (in bytes)
+ *                    buf:  Data
+ *    Return Value:   (adr+sz) - OK, Failed Address
+ */
+uint32_t Verify(uint32_t adr, uint32_t sz, uint32_t *buf)
+{
+    uint32_t n;
+
+    if ((adr == 0) && (sz >= 0x20))              // Signature inserted by ProgramPage
+    {
+        n = buf[0] + buf[1] + buf[2] + buf[3] + buf[4] + buf[5] + buf[6];
+        buf[7] = 0 - n;
+    }
+
+    if ((((adr | (uint32_t)buf | sz) & 3) == 0) && sz)
+    {
+        if (FLASHIAP_Compare(adr, buf, sz) == kStatus_Success)
+        {
+            return (adr + sz);
+        }
+    }
+
+    /* Mismatch or unaligned block: locate the first differing byte */
+    return CompareWords(adr, sz, (uint8_t *)buf, 0);
+}
@@ -60,6 +60,7 @@
 #define _FSL_FLASHIAP_H_
 
 #include "fsl_common.h"
+#include "FlashStats.h"
 
 /*!
  * @addtogroup flashiap_driver
@@ -156,7 +157,9 @@ extern "C" {
  */
 static inline void iap_entry(uint32_t *cmd_param, uint32_t *status_result)
 {
+    FLASH_STATS_BUSY_BEGIN();
     ((IAP_ENTRY_T)FSL_FEATURE_SYSCON_IAP_ENTRY_LOCATION)(cmd_param, status_result);
+    FLASH_STATS_BUSY_END();
 }
 
 /*!
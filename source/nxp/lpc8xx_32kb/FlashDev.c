@@ -25,6 +25,7 @@
  * --------------------------------------------------------------------------- */
 
 #include "FlashOS.H"        // FlashOS Structures
+#include "FlashDev.h"
 
 #define FLASH_DRV_VERS (0x0100+VERS)   // Driver Version, do not modify!
 
@@ -34,13 +35,17 @@ struct FlashDevice const FlashDevice  =  {
    ONCHIP,                     // Device Type
    0x00000000,                 // Device Start Address
    0x00008000,                 // Device Size (32kB)
-   256,                        // Programming Page Size
+   IAP_PAGE_SIZE,              // Programming Page Size
    0,                          // Reserved, must be 0
    0xFF,                       // Initial Content of Erased Memory
    300,                        // Program Page Timeout 300 mSec
    3000,                       // Erase Sector Timeout 3000 mSec
 
 // Specify Size and Address of Sectors
+#ifdef IAP_ERASE_PAGE
+   IAP_ERASE_SIZE, 0x000000,   // Erase Page Size
+#else
    0x000400, 0x000000,         // Sector Size  1kB (32 Sectors)
+#endif
    SECTOR_END
 };
@@ -23,7 +23,7 @@ struct FlashDevice const FlashDevice = {
     EXTSPI,                 // Device Type
     FLASH_START,            // Device Start Address
     FLASH_DEV_SIZE,         // Device Size
-    256,                    // Programming Page Size
+    FLASH_PAGE_SIZE,        // Programming Page Size
     0,                      // Reserved, must be 0
     0xFF,                   // Initial Content of Erased Memory
     500,                    // Program Page Timeout 500 mSec
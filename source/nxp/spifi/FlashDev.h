@@ -47,4 +47,22 @@
   #define FLASH_SECTOR_SIZE       (4 * 1024)
 #endif  
 
+// SPIFI Clock
+// Default 12 MHz IRC; SPIFI_CLK_PLL1 runs SPIFI from PLL1 at the flash's
+// rated speed, SPIFI_CLK_MHZ must be a multiple of the 12 MHz IRC
+#if defined(SPIFI_CLK_PLL1)
+  #ifndef SPIFI_CLK_MHZ
+  #define SPIFI_CLK_MHZ           96
+  #endif
+  #if (SPIFI_CLK_MHZ % 12) || (SPIFI_CLK_MHZ < 24) || (SPIFI_CLK_MHZ > 104)
+  #error "SPIFI_CLK_MHZ must be a multiple of 12 between 24 and 104"
+  #endif
+#else
+  #define SPIFI_CLK_MHZ           12
+#endif
+
+#define FLASH_PAGE_SIZE         256
+#define FLASH_SECTOR_COUNT      (FLASH_DEV_SIZE / FLASH_SECTOR_SIZE)
+#define FLASH_SECTOR_PAGES      (FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE)
+
 #endif
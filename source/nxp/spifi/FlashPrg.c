@@ -19,8 +19,30 @@
 
 #include "spifi_rom_api.h"
 
+#define CGU_PLL1_STAT           (*(volatile unsigned long *)0x40050040)
+#define CGU_PLL1_CTRL           (*(volatile unsigned long *)0x40050044)
+#define CGU_BASE_M4_CLK         (*(volatile unsigned long *)0x4005006C)
 #define CGU_BASE_SPIFI0_CLK     (*(volatile unsigned long *)0x40050070)
 
+#define CGU_CLK_SEL_IRC         (0x01 << 24)
+#define CGU_CLK_SEL_PLL1        (0x09 << 24)
+#define CGU_CLK_SEL_MASK        (0x1F << 24)
+#define CGU_AUTOBLOCK           (1 << 11)
+
+#ifdef SPIFI_CLK_PLL1
+// PLL1 from IRC in integer mode: Fout = M * 12 MHz, Fcco = Fout * 2P (156..320 MHz)
+#define PLL1_MSEL               ((SPIFI_CLK_MHZ / 12) - 1)
+#if SPIFI_CLK_MHZ >= 84
+#define PLL1_PSEL               0               // 2P = 2
+#elif SPIFI_CLK_MHZ >= 48
+#define PLL1_PSEL               1               // 2P = 4
+#else
+#define PLL1_PSEL               2               // 2P = 8
+#endif
+#define PLL1_CTRL_VAL           (CGU_CLK_SEL_IRC | PLL1_MSEL << 16 | PLL1_PSEL << 8 | \
+                                 CGU_AUTOBLOCK | 1 << 6)  // NSEL = 0, FBSEL
+#endif
+
 #define SCU_SFSP3_3             (*(volatile unsigned long *)0x4008618C)
 #define SCU_SFSP3_4             (*(volatile unsigned long *)0x40086190)
 #define SCU_SFSP3_5             (*(volatile unsigned long *)0x40086194)
@@ -33,6 +55,74 @@ SPIFIopers opers;
 
 unsigned long base_adr;
 
+// Erased pages at the end of each sector, FLASH_SECTOR_PAGES after an erase in
+// this session and lowered as pages get programmed. ProgramPage skips the
+// library erase for pages in this range.
+#if FLASH_SECTOR_PAGES > 255
+unsigned short erased[FLASH_SECTOR_COUNT];
+#else
+unsigned char erased[FLASH_SECTOR_COUNT];
+#endif
+
+#ifdef SPIFI_CLK_PLL1
+unsigned long pll1_ctrl_saved;
+#endif
+
+static void SetErased (unsigned long sec, unsigned long cnt) {
+    while (cnt--) {
+        erased[sec++] = FLASH_SECTOR_PAGES;
+    }
+}
+
+static void ClearErased (void) {
+    unsigned long i;
+
+    for (i = 0; i < FLASH_SECTOR_COUNT; i++) {
+        erased[i] = 0;
+    }
+}
+
+// Check that all pages touched by [ofs, ofs+sz) were erased this session
+// and not programmed since
+static int IsErased (unsigned long ofs, unsigned long sz) {
+    unsigned long end = ofs + sz;
+
+    if (end > FLASH_DEV_SIZE) {
+        return 0;
+    }
+    while (ofs < end) {
+        if ((ofs % FLASH_SECTOR_SIZE) / FLASH_PAGE_SIZE <
+            FLASH_SECTOR_PAGES - erased[ofs / FLASH_SECTOR_SIZE]) {
+            return 0;
+        }
+        ofs = (ofs / FLASH_SECTOR_SIZE + 1) * FLASH_SECTOR_SIZE;
+    }
+    return 1;
+}
+
+// Lower the erased range of the sectors touched by [ofs, ofs+sz)
+static void SetProgrammed (unsigned long ofs, unsigned long sz) {
+    unsigned long end = ofs + sz;
+    unsigned long sec, top, pages;
+
+    if (end > FLASH_DEV_SIZE) {
+        return;
+    }
+    while (ofs < end) {
+        sec = ofs / FLASH_SECTOR_SIZE;
+        top = (sec + 1) * FLASH_SECTOR_SIZE;
+        if (top > end) {
+            top = end;
+        }
+        // Pages from the last one written to the end of the sector
+        pages = FLASH_SECTOR_PAGES - ((top - 1) % FLASH_SECTOR_SIZE) / FLASH_PAGE_SIZE - 1;
+        if (erased[sec] > pages) {
+            erased[sec] = pages;
+        }
+        ofs = top;
+    }
+}
+
 /*  Initialize Flash Programming Functions
  *    Parameter:      adr:  Device Base Address
  *                    clk:  Clock Frequency (Hz)
@@ -41,6 +131,7 @@ unsigned long base_adr;
  */
 int Init (unsigned long adr, unsigned long clk, unsigned long fnc) {
     int32_t rc;
+    unsigned long spifi_mhz = SPIFI_CLK_MHZ;
 
     opers.dest    = NULL;
     opers.length  = 0;
@@ -50,8 +141,31 @@ int Init (unsigned long adr, unsigned long clk, unsigned long fnc) {
 
     base_adr = adr;
 
+    // A program pass keeps the sectors erased by the erase pass before it,
+    // anything else starts without knowledge of the flash contents
+    if (fnc != 2) {
+        ClearErased();
+    }
+
     // Init SPIFI clock and pins
-    CGU_BASE_SPIFI0_CLK = 1<<24 | 1<<11; // IRC 12 MHz is good enough for us
+#ifdef SPIFI_CLK_PLL1
+    // Switch SPIFI to IRC while PLL1 is (re)configured
+    CGU_BASE_SPIFI0_CLK = CGU_CLK_SEL_IRC | CGU_AUTOBLOCK;
+    if ((CGU_BASE_M4_CLK & CGU_CLK_SEL_MASK) == CGU_CLK_SEL_PLL1) {
+        // The core runs from PLL1, leave it alone and stay on IRC
+        spifi_mhz = 12;
+    } else {
+        if (pll1_ctrl_saved == 0) {
+            pll1_ctrl_saved = CGU_PLL1_CTRL;
+        }
+        CGU_PLL1_CTRL = PLL1_CTRL_VAL | 1;  // Powered down while configured
+        CGU_PLL1_CTRL = PLL1_CTRL_VAL;
+        while ((CGU_PLL1_STAT & 1) == 0);   // Wait for Lock
+        CGU_BASE_SPIFI0_CLK = CGU_CLK_SEL_PLL1 | CGU_AUTOBLOCK;
+    }
+#else
+    CGU_BASE_SPIFI0_CLK = CGU_CLK_SEL_IRC | CGU_AUTOBLOCK; // IRC 12 MHz is good enough for us
+#endif
 
     // set up SPIFI I/O (undocumented bit 7 set as 1, Aug 2 2011)
     SCU_SFSP3_3 = 0xF3; // High drive for SCLK
@@ -62,7 +176,7 @@ int Init (unsigned long adr, unsigned long clk, unsigned long fnc) {
     SCU_SFSP3_7 = 0xD3;
     SCU_SFSP3_8 = 0x13; // CS doesn't need feedback
 
-    rc = spifi_init(&obj, 3, S_RCVCLK | S_FULLCLK, 12);
+    rc = spifi_init(&obj, 3, S_RCVCLK | S_FULLCLK, spifi_mhz);
 
     return ((rc != 0) ? 1 : 0);  // 0 = No errors, 1 = Errors encountered
 }
@@ -72,6 +186,14 @@ int Init (unsigned long adr, unsigned long clk, unsigned long fnc) {
  *    Return Value:   0 - OK,  1 - Failed
  */
 int UnInit (unsigned long fnc) {
+#ifdef SPIFI_CLK_PLL1
+    // Back to IRC, PLL1 as found at the first Init; memory mapped reads
+    // only get slower than the timing set up by spifi_init
+    CGU_BASE_SPIFI0_CLK = CGU_CLK_SEL_IRC | CGU_AUTOBLOCK;
+    if (pll1_ctrl_saved != 0) {          // PLL1 was not touched when the core runs from it
+        CGU_PLL1_CTRL = pll1_ctrl_saved;
+    }
+#endif
     return 0;
 }
 
@@ -87,10 +209,14 @@ int EraseChip (void) {
 
     // External flash may include data or filesystem sectors.
     // Only perform chip erase when all data can be discarded.
+    FLASH_STATS_BUSY_BEGIN();
     rc = spifi_erase(&obj, &opers);
+    FLASH_STATS_BUSY_END();
     if (rc != 0) 
         return (rc);
 
+    SetErased(0, FLASH_SECTOR_COUNT);
+
     return ((rc != 0) ? 1 : 0);
 }
 
@@ -106,9 +232,14 @@ int EraseSector (unsigned long adr) {
     opers.scratch = SECTOR_BUF;
     opers.options = S_VERIFY_ERASE;
 
+    FLASH_STATS_BUSY_BEGIN();
     rc = spifi_erase(&obj, &opers);
+    FLASH_STATS_BUSY_END();
+    if (rc != 0)
+        return (1);
 
-    return ((rc != 0) ? 1 : 0);
+    SetErased((adr - base_adr) / FLASH_SECTOR_SIZE, 1);
+    return (0);
 }
 
 /*  Program Page in Flash Memory
@@ -126,9 +257,74 @@ int ProgramPage (unsigned long adr, unsigned long sz, unsigned char *buf) {
     opers.protect = 0;
     // Use S_CALLER_ERASE if caller previously erased sector,
     //     S_VERIFY_ERASE to erase sector before programming
-    opers.options = S_VERIFY_ERASE;
+    if (IsErased(adr - base_adr, sz)) {
+        opers.options = S_CALLER_ERASE;
+    } else {
+        opers.options = S_VERIFY_ERASE;
+    }
 
+    FLASH_STATS_BUSY_BEGIN();
     rc = spifi_program(&obj, (char *)buf, &opers);
+    FLASH_STATS_BUSY_END();
+
+    // Pages up to the one just written are no longer blank
+    SetProgrammed(adr - base_adr, sz);
 
     return ((rc != 0) ? 1 : 0);
 }
+
+/*  Verify Flash Contents through the memory mapped SPIFI window
+ *    Parameter:      adr:  Start Address
+ *                    sz:   Size (in bytes)
+ *                    buf:  Data
+ *    Return Value:   (adr+sz) - OK, Failed Address
+ */
+unsigned long Verify (unsigned long adr, unsigned long sz, unsigned char *buf) {
+    set_mem_mode(&obj);
+
+    if (((adr | (unsigned long)buf) & 3) == 0) {
+        while (sz >= 4) {
+            if (*((volatile unsigned long *)adr) != *((unsigned long *)buf))
+                break;
+            adr += 4;
+            buf += 4;
+            sz  -= 4;
+        }
+    }
+    while (sz) {
+        if (*((volatile unsigned char *)adr) != *buf)
+            break;
+        adr += 1;
+        buf += 1;
+        sz  -= 1;
+    }
+
+    return (adr);
+}
+
+/*  Calculate CRC-32 (IEEE 802.3) of Flash Contents through the memory
+ *  mapped SPIFI window, lets the host check a whole image in one call
+ *    Parameter:      adr:  Start Address
+ *                    sz:   Size (in bytes)
+ *    Return Value:   CRC-32 of the Block
+ */
+unsigned long Crc32 (unsigned long adr, unsigned long sz) {
+    static const unsigned long tab[16] = {       // CRC-32 (0xEDB88320) per Nibble
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+        0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+        0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    unsigned long crc = 0xFFFFFFFF;
+    unsigned char *p = (unsigned char *)adr;
+
+    set_mem_mode(&obj);
+
+    while (sz--) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ tab[crc & 0x0F];
+        crc = (crc >> 4) ^ tab[crc & 0x0F];
+    }
+
+    return (~crc);
+}
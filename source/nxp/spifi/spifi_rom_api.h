@@ -224,6 +224,8 @@ extern SPIFI_RTNS spifi_table;
 int32_t spifi_init (SPIFIobj *obj, uint32_t csHigh, uint32_t options, uint32_t mhz);
 int32_t spifi_program (SPIFIobj *obj, char *source, SPIFIopers *opers);
 int32_t spifi_erase (SPIFIobj *obj, SPIFIopers *opers);
+void cancel_mem_mode (SPIFIobj *obj);
+void set_mem_mode (SPIFIobj *obj);
 
 /* these are used by the manufacturer-specific init functions */
 void setSize (SPIFIobj *obj, int32_t value);
@@ -17,6 +17,8 @@
 /** @file FlashDev.c */
 
 #include "FlashOS.H"
+#include "types.h"
+#include "flash.h"
 
 #define FLASH_DRV_VERS (0x0100+VERS)   // Driver Version, do not modify!
 #define DEVICE_NAME    "NCS36510 640 KB Flash"
@@ -27,11 +29,11 @@ struct FlashDevice const FlashDevice = {
     ONCHIP,                     // Device Type
     0x00002000,                 // Device Start Address
     0x00152000,                 // Device Size (Flash A 316K + Flash B 320K)
-    0x00000800,                 // Programming Page Size
+    0x00001000,                 // Programming Page Size (may span flash pages)
     0x00000000,                 // Reserved, must be 0
     0xFF,                       // Initial Content of Erased Memory
     0x00000064,                 // Program Page Timeout 100 mSec
     0x00000BB8,                 // Erase Sector Timeout 3000 mSec
-    {{0x00000400, 0x00000000},  // Sector Size {1kB, starting at address 0}
+    {{FLASH_PAGE_SIZE, 0x00000000},  // Sector Size {one flash page per SIREV, starting at address 0}
     {SECTOR_END}}
 };
@@ -30,6 +30,11 @@
 #define DEVICE_OPT_REG_ADRS        (uint32_t)0x4001E000
 #define DEVICE_OPT_ALL_FEATURE_EN  (uint32_t)0x2082353F
 
+/* User area of each bank, 0x2000 - 0x52000 relative to the bank base */
+#define FLASH_USER_AREA_SIZE       (uint32_t)0x50000
+#define FLASH_USER_AREA_PAGES      (FLASH_USER_AREA_SIZE / FLASH_PAGE_SIZE)
+#define FLASH_ERASED_WORDS         ((2 * FLASH_USER_AREA_PAGES + 31) / 32)
+
 void fInitGobjects(void);
 void fInitRam(void);
 
@@ -50,6 +55,37 @@ const flash_options_t GlobFlashOptionsB =
 
 uint8_t numDev;
 
+/** Pages erased during this session, bank A followed by bank B */
+static uint32_t erased[FLASH_ERASED_WORDS];
+
+static uint32_t PageIndex(uint32_t adr)
+{
+    uint32_t bank = (adr & FLASH_B_OFFSET_MASK) ? FLASH_USER_AREA_PAGES : 0;
+
+    return bank + ((adr & ~FLASH_B_OFFSET_MASK) - FLASH_A_USER_AREA_OFFSET) / FLASH_PAGE_SIZE;
+}
+
+static void SetErased(uint32_t adr, uint32_t erase)
+{
+    uint32_t page = PageIndex(adr);
+
+    if (erase)
+    {
+        erased[page / 32] |= (1UL << (page % 32));
+    }
+    else
+    {
+        erased[page / 32] &= ~(1UL << (page % 32));
+    }
+}
+
+static uint32_t IsErased(uint32_t adr)
+{
+    uint32_t page = PageIndex(adr);
+
+    return (erased[page / 32] >> (page % 32)) & 1;
+}
+
 uint32_t Init(uint32_t adr, uint32_t clk, uint32_t fnc)
 {
     // Called to configure the SoC. Should enable clocks
@@ -79,7 +115,21 @@ uint32_t Init(uint32_t adr, uint32_t clk, uint32_t fnc)
     __DSB();
 #endif
 
-    fFlashIoctl((flash_options_pt)&GlobFlashOptionsB, FLASH_POWER_UP, 0);
+    /* Bring up both banks, unless still powered from an earlier Init of this session */
+    if (FLASHREG->CONTROL.BITS.FLASHA_PD)
+    {
+        fFlashIoctl((flash_options_pt)&GlobFlashOptionsA, FLASH_POWER_UP, 0);
+    }
+    if (FLASHREG->CONTROL.BITS.FLASHB_PD)
+    {
+        fFlashIoctl((flash_options_pt)&GlobFlashOptionsB, FLASH_POWER_UP, 0);
+    }
+
+    /* Erase state is only known for pages erased in this session */
+    for (uint32_t i = 0; i < FLASH_ERASED_WORDS; i++)
+    {
+        erased[i] = 0;
+    }
     return RESULT_OK;
 }
 
@@ -105,8 +155,16 @@ uint32_t EraseChip(void)
 {
     /* Erases the entire of flash memory region both flash A & B */
 
-    fFlashMassErase((flash_options_pt)&GlobFlashOptionsA);
-    fFlashMassErase((flash_options_pt)&GlobFlashOptionsB);
+    /* The banks are separate arrays, erase them in parallel */
+    fFlashMassEraseStart((flash_options_pt)&GlobFlashOptionsA);
+    fFlashMassEraseStart((flash_options_pt)&GlobFlashOptionsB);
+    fFlashStallUntilNotBusy((flash_options_pt)&GlobFlashOptionsA);
+    fFlashStallUntilNotBusy((flash_options_pt)&GlobFlashOptionsB);
+
+    for (uint32_t i = 0; i < FLASH_ERASED_WORDS; i++)
+    {
+        erased[i] = 0xFFFFFFFF;
+    }
 
     return RESULT_OK;
 }
@@ -117,11 +175,19 @@ uint32_t EraseSector(uint32_t adr)
     {
         if((adr >= 0x2000) && (adr < 0x52000))
         {
-            fFlashIoctl((flash_options_pt)&GlobFlashOptionsA, FLASH_PAGE_ERASE_REQUEST, &adr);
+            if (!IsErased(adr))
+            {
+                fFlashIoctl((flash_options_pt)&GlobFlashOptionsA, FLASH_PAGE_ERASE_REQUEST, &adr);
+                SetErased(adr, 1);
+            }
         }
         else if ((adr >= 0x00102000) && (adr < 0x00152000))
         {
-            fFlashIoctl((flash_options_pt)&GlobFlashOptionsB, FLASH_PAGE_ERASE_REQUEST, &adr);
+            if (!IsErased(adr))
+            {
+                fFlashIoctl((flash_options_pt)&GlobFlashOptionsB, FLASH_PAGE_ERASE_REQUEST, &adr);
+                SetErased(adr, 1);
+            }
         }
         return RESULT_OK;
     }
@@ -131,24 +197,35 @@ uint32_t EraseSector(uint32_t adr)
 uint32_t ProgramPage(uint32_t adr, uint32_t sz, uint32_t *buf)
 {
     boolean retVal = True;
+    uint32_t start = adr;
 
     if(adr >= FLASH_A_USER_AREA_OFFSET)
     {
-        /* Write to flash A or Flash B depending on the flash bank in use */
-        if((adr >= 0x2000) && (adr < 0x52000))
+        /* Write to flash A or Flash B depending on the flash bank in use,
+         * the buffer may span several pages but not both banks */
+        if((adr >= 0x2000) && (adr + sz <= 0x52000))
         {
             retVal = fFlashWrite((flash_options_pt)&GlobFlashOptionsA,(uint8_t **)&adr,
                                                (uint8_t const *)buf,sz);
         }
-        else if ((adr >= 0x00102000) && (adr < 0x00152000))
+        else if ((adr >= 0x00102000) && (adr + sz <= 0x00152000))
         {
             retVal = fFlashWrite((flash_options_pt)&GlobFlashOptionsB,(uint8_t **)&adr,
                                                (uint8_t const *)buf,sz);
         }
+        else
+        {
+            retVal = False;
+        }
 
         if(retVal == True)
         {
-          return RESULT_OK;
+            /* Programmed pages need a real erase if they are requested again */
+            for (uint32_t page = start & FLASH_PAGE_MASK; page < start + sz; page += FLASH_PAGE_SIZE)
+            {
+                SetErased(page, 0);
+            }
+            return RESULT_OK;
         }
     }
     return RESULT_ERROR;
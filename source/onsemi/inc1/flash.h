@@ -90,6 +90,7 @@ boolean fFlashIoctl(flash_options_pt device, uint32_t request, void *argument);
 void fFlashPageErase(flash_options_pt device, uint32_t address);
 void fFlashPowerUp(flash_options_pt device);
 void fFlashStallUntilNotBusy(flash_options_pt device);
+void fFlashMassEraseStart(flash_options_pt device);
 void fFlashMassErase(flash_options_pt device);
 
 #endif // FLASH_H_
@@ -27,6 +27,7 @@
 
 #include "flash_map.h"
 #include "flash.h"
+#include "FlashStats.h"
 #include <string.h>
 
 extern int debug_flag;   
@@ -108,6 +109,7 @@ void fFlashUnlock(flash_options_pt device)
  */
 void fFlashStallUntilNotBusy(flash_options_pt device)
 {
+     FLASH_STATS_BUSY_BEGIN();
      if (device->array_base_address & FLASH_B_OFFSET_MASK) 
      {/* Check flash B busy */
           while (device->membase->STATUS.BITS.FLASH_B_BUSY);
@@ -116,6 +118,7 @@ void fFlashStallUntilNotBusy(flash_options_pt device)
      {/* Check flash A busy */
           while (device->membase->STATUS.BITS.FLASH_A_BUSY);
      }
+     FLASH_STATS_BUSY_END();
 }
 
 /** Power down the flash
@@ -171,13 +174,13 @@ void fFlashPageErase(flash_options_pt device, uint32_t address)
     fFlashStallUntilNotBusy(device);
 }
 
-/** Erases a flash page
+/** Starts a mass erase of the user area of a flash bank
  * It is up to the caller to make sure busy flag is checked before continuing.
+ * Banks A and B have their own busy flags, so both can be erased at once.
  *
  * @param device pointer to the flash device
- * @param address address, relative to flash, does not need to be page start
  */
-void fFlashMassErase(flash_options_pt device)
+void fFlashMassEraseStart(flash_options_pt device)
 {
      /* Only one mass erase control address is available for both flash banks.
       * Hardware is masking least significant bits to identify what page
@@ -194,7 +197,15 @@ void fFlashMassErase(flash_options_pt device)
 
      /* Kick off erase cycle. */
      device->membase->COMMAND.WORD = CMD_MASS_ERASE;
+}
 
+/** Mass erases the user area of a flash bank
+ *
+ * @param device pointer to the flash device
+ */
+void fFlashMassErase(flash_options_pt device)
+{
+     fFlashMassEraseStart(device);
      fFlashStallUntilNotBusy(device);
 }
 
@@ -230,74 +241,90 @@ boolean fFlashRead(flash_options_pt device, uint8_t **address, uint8_t * const b
      return True;
 }
 
+/**
+ * Commit one chunk that does not cross a page boundary
+ *
+ * The CM3 is stalled on every store while the controller programs it, so the
+ * bulk of the chunk is committed with 32-bit stores; only an unaligned head
+ * or tail falls back to byte stores.
+ */
+static void fFlashWriteChunk(uint8_t *destination, const uint8_t *buffer, uint32_t len)
+{
+     while ((len > 0) && ((uint32_t)destination & 0x3))
+     {
+          *destination++ = *buffer++;
+          len--;
+     }
+
+     if (((uint32_t)buffer & 0x3) == 0)
+     {
+          volatile uint32_t *dst_word = (volatile uint32_t *)destination;
+          const uint32_t *src_word = (const uint32_t *)buffer;
+
+          for (; len >= 4; len -= 4)
+          {
+               *dst_word++ = *src_word++;
+          }
+          destination = (uint8_t *)dst_word;
+          buffer = (const uint8_t *)src_word;
+     }
+
+     while (len-- > 0)
+     {
+          *destination++ = *buffer++;
+     }
+}
+
 /**
  * Note: bootloader section (first 8K) can only be flashed when the test pin is 1 and the flash is
  * unlocked.
  *
- * @todo add support for at least 1 write across page boundary
+ * Writes crossing page boundaries are split per page internally; the busy flag is only
+ * checked once each page has been committed.
  */
 boolean fFlashWrite(flash_options_pt device, uint8_t **address, const uint8_t *buf, uint32_t len)
 {
      uint8_t *destination;
-     uint8_t *in_page_offset;
      const uint8_t *buffer;
+     uint32_t page_size;
+     uint32_t chunk;
 
      destination = (uint8_t*) (*address);
      buffer  = buf;
 
-     //fprintf("Destination = %0x", destination);
-       
-     if ((uint32_t) (*address) < (FLASH_NR_INFO_BLOCK_PAGES * FLASH_PAGE_SIZE_INFO_BLOCK )) 
-     {
-          // First page write requested, info block has FLASH_NR_INFO_BLOCK_PAGES pages of size FLASH_PAGE_SIZE_INFO_BLOCK.
+    /* Make sure the CM3 hangs while write is ongoing */
+    device->membase->CONTROL.BITS.WRITE_BLOCK = CTRL_STALL_ON_WRITE;
 
-          /* No support for crossing page boundary */
-          if (((uint32_t) (*address) % FLASH_PAGE_SIZE_INFO_BLOCK ) == 0) 
+     while (len > 0)
+     {
+          if (((uint32_t) destination & ~FLASH_B_OFFSET_MASK) < (FLASH_NR_INFO_BLOCK_PAGES * FLASH_PAGE_SIZE_INFO_BLOCK ))
           {
-               // Address is page aligned
-               if (len > FLASH_PAGE_SIZE_INFO_BLOCK)
-               {
-                    return False;
-               }
+               // Info block has FLASH_NR_INFO_BLOCK_PAGES pages of size FLASH_PAGE_SIZE_INFO_BLOCK.
+               page_size = FLASH_PAGE_SIZE_INFO_BLOCK;
           }
-          else 
+          else
           {
-               in_page_offset = (uint8_t*) ((uint32_t) (*address) & ~FLASH_FIRST_PAGE_MASK );
-               if (len > ((uint32_t)FLASH_PAGE_SIZE_INFO_BLOCK - (uint32_t)in_page_offset ))     
-               {
-                    return False;
-               }
+               page_size = FLASH_PAGE_SIZE;
           }
-     }
 
-     /* No support for crossing page boundary */
-     if (((uint32_t) (*address) % FLASH_PAGE_SIZE ) == 0)
-     {
-          // Address is page aligned
-          if (len > FLASH_PAGE_SIZE)
+          // Amount of space remaining before the start of the next page
+          chunk = page_size - ((uint32_t) destination & (page_size - 1));
+          if (chunk > len)
           {
-            //length is larger than a page - not supported
-               return False;
+               chunk = len;
           }
-     } 
-     else 
-     {
-          in_page_offset = (uint8_t*) ((uint32_t) (*address) & ~FLASH_PAGE_MASK );
-          if (len > ((uint32_t)FLASH_PAGE_SIZE - (uint32_t)in_page_offset ))     
-          {
-               //length is larger than amount of space remaining before the start of the next page - not supported
-               return False;
-          }
-     }
 
-    /* Make sure the CM3 hangs while write is ongoing */
-    device->membase->CONTROL.BITS.WRITE_BLOCK = CTRL_STALL_ON_WRITE;
-    
-    fFlashUnlock(device);
+          fFlashUnlock(device);
 
-    /* Commit the page to flash */
-    memcpy((void *)destination, (void *)buffer, len);
-    fFlashStallUntilNotBusy(device);
+          /* Commit the page to flash */
+          fFlashWriteChunk(destination, buffer, chunk);
+          fFlashStallUntilNotBusy(device);
+
+          destination += chunk;
+          buffer += chunk;
+          len -= chunk;
+     }
+     *address = destination;
 
      return True;
 }
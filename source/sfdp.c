@@ -0,0 +1,182 @@
+/* Flash OS Routines
+ * Copyright (c) 2009-2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file sfdp.c */
+
+#include "sfdp.h"
+
+/*
+ * JEDEC Serial Flash Discoverable Parameters (JESD216) parser.
+ */
+#define SFDP_SIGNATURE      (0x50444653)    // "SFDP"
+#define SFDP_BFPT_ID        (0xFF00)        // Basic Flash Parameter Table
+#define SFDP_4BAIT_ID       (0xFF84)        // 4-Byte Address Instruction Table
+#define SFDP_BFPT_MAX       (16)            // DWORDs used from the BFPT
+
+/* DWORD n (1-based, as numbered by JESD216) of a parameter table */
+#define DWORD(tab, n)       (get32((tab) + 4 * ((n) - 1)))
+
+/* local functions */
+
+static uint32_t get32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t headerId(const uint8_t *hdr)
+{
+    return hdr[0] | (hdr[7] << 8);
+}
+
+static uint32_t headerPtr(const uint8_t *hdr)
+{
+    return hdr[4] | (hdr[5] << 8) | (hdr[6] << 16);
+}
+
+static void sortEraseTypes(sfdp_info_t *info)
+{
+    uint32_t size;
+    uint8_t op;
+
+    for (int i = 1; i < SFDP_ERASE_TYPES; i++) {
+        for (int j = i; j > 0; j--) {
+            // Unused types (size 0) go last
+            if (info->erase_size[j] == 0 ||
+                (info->erase_size[j - 1] != 0 && info->erase_size[j - 1] <= info->erase_size[j])) {
+                break;
+            }
+            size = info->erase_size[j];
+            op = info->erase_op[j];
+            info->erase_size[j] = info->erase_size[j - 1];
+            info->erase_op[j] = info->erase_op[j - 1];
+            info->erase_size[j - 1] = size;
+            info->erase_op[j - 1] = op;
+        }
+    }
+}
+
+/* sfdp.h interface */
+
+uint32_t sfdp_parse(sfdp_read_t read, sfdp_info_t *info)
+{
+    sfdp_info_t nor;
+    uint8_t hdr[8];
+    uint8_t tab[4 * SFDP_BFPT_MAX];
+    uint32_t nph;
+    uint32_t len;
+    uint32_t val;
+
+    // SFDP header
+    if (read(0x000000, hdr, sizeof(hdr)) != 0) {
+        return 1;
+    }
+    if (get32(hdr) != SFDP_SIGNATURE) {
+        return 1;
+    }
+    nph = hdr[6] + 1;
+
+    // The first parameter header always describes the BFPT
+    if (read(0x000008, hdr, sizeof(hdr)) != 0) {
+        return 1;
+    }
+    len = hdr[3];
+    if (headerId(hdr) != SFDP_BFPT_ID || len < 9) {
+        return 1;
+    }
+    if (len > SFDP_BFPT_MAX) {
+        len = SFDP_BFPT_MAX;
+    }
+    if (read(headerPtr(hdr), tab, 4 * len) != 0) {
+        return 1;
+    }
+
+    // Density, in bits
+    val = DWORD(tab, 2);
+    if (val & 0x80000000) {
+        val &= 0x7FFFFFFF;
+        if (val < 3 || val > 34) {
+            return 1;
+        }
+        nor.size = 1UL << (val - 3);
+    } else {
+        nor.size = (val >> 3) + 1;
+    }
+
+    // Erase types 1..4, size given as 2^N bytes
+    for (int i = 0; i < SFDP_ERASE_TYPES; i++) {
+        val = DWORD(tab, 8 + i / 2) >> (16 * (i & 1));
+        nor.erase_size[i] = (val & 0xFF) ? (1UL << (val & 0xFF)) : 0;
+        nor.erase_op[i] = (val >> 8) & 0xFF;
+    }
+    if (nor.erase_size[0] == 0 && (DWORD(tab, 1) & 0x3) == 0x1) {
+        // Only the legacy 4KB erase field is filled in
+        nor.erase_size[0] = 0x1000;
+        nor.erase_op[0] = (DWORD(tab, 1) >> 8) & 0xFF;
+    }
+
+    // Address bytes: 3 only, 3 or 4, 4 only
+    val = (DWORD(tab, 1) >> 17) & 0x3;
+    nor.addr_bytes = (val == 2 || (val == 1 && nor.size > 0x1000000)) ? 4 : 3;
+
+    // Page size and quad enable method were added by JESD216A/B
+    nor.page_size = (len >= 11) ? (1UL << ((DWORD(tab, 11) >> 4) & 0xF)) : 256;
+    nor.quad_enable = (len >= 15) ? ((DWORD(tab, 15) >> 20) & 0x7) : 0;
+
+    // Page program opcodes are not part of the BFPT, parts reading 1-1-4 use 0x32
+    nor.prog_op = 0x02;
+    nor.quad_prog_op = (DWORD(tab, 1) & (1 << 22)) ? 0x32 : 0x00;
+
+    // 4-byte address opcodes, when the part provides them
+    for (uint32_t n = 1; nor.addr_bytes == 4 && n < nph; n++) {
+        if (read(0x000008 + 8 * n, hdr, sizeof(hdr)) != 0) {
+            return 1;
+        }
+        if (headerId(hdr) != SFDP_4BAIT_ID || hdr[3] < 2) {
+            continue;
+        }
+        if (read(headerPtr(hdr), tab, 8) != 0) {
+            return 1;
+        }
+        val = DWORD(tab, 1);
+        nor.prog_op = (val & (1 << 6)) ? 0x12 : nor.prog_op;
+        nor.quad_prog_op = (val & (1 << 7)) ? 0x34 : nor.quad_prog_op;
+        for (int i = 0; i < SFDP_ERASE_TYPES; i++) {
+            if (val & (1 << (9 + i))) {
+                nor.erase_op[i] = (DWORD(tab, 2) >> (8 * i)) & 0xFF;
+            }
+        }
+        break;
+    }
+
+    sortEraseTypes(&nor);
+    if (nor.erase_size[0] == 0) {
+        return 1;
+    }
+
+    *info = nor;
+    return 0;
+}
+
+int32_t sfdp_erase_type(const sfdp_info_t *info, uint32_t adr, uint32_t sz)
+{
+    for (int32_t i = SFDP_ERASE_TYPES - 1; i >= 0; i--) {
+        uint32_t size = info->erase_size[i];
+        if (size != 0 && size <= sz && (adr & (size - 1)) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
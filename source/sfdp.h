@@ -0,0 +1,72 @@
+/* Flash OS Routines
+ * Copyright (c) 2009-2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file sfdp.h */
+
+#ifndef SFDP_H
+#define SFDP_H
+
+#include "stdint.h"
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
+/** Number of erase types described by the Basic Flash Parameter Table */
+#define SFDP_ERASE_TYPES    4
+
+/** Geometry and commands of a serial NOR flash, see JESD216 */
+typedef struct {
+    uint32_t size;                              ///< device size in bytes
+    uint32_t page_size;                         ///< program page size in bytes
+    uint32_t erase_size[SFDP_ERASE_TYPES];      ///< erase type sizes in bytes, ascending, 0 if unused
+    uint8_t  erase_op[SFDP_ERASE_TYPES];        ///< erase type opcodes
+    uint8_t  addr_bytes;                        ///< address bytes used by the commands below, 3 or 4;
+                                                ///< without 4-byte opcodes the part has to be put into
+                                                ///< 4-byte address mode by the caller
+    uint8_t  prog_op;                           ///< single line page program opcode
+    uint8_t  quad_prog_op;                      ///< 1-1-4 page program opcode, 0 if not supported
+    uint8_t  quad_enable;                       ///< quad enable requirement (BFPT DWORD15 QER field)
+} sfdp_info_t;
+
+/** Read callback of the transport
+    @param adr SFDP address to read from
+    @param buf destination buffer
+    @param sz number of bytes to read
+    @return 0 on success, an error code otherwise
+ */
+typedef uint32_t (*sfdp_read_t)(uint32_t adr, uint8_t *buf, uint32_t sz);
+
+/** Read and parse the SFDP tables of a serial NOR flash
+    @param read transport function issuing the Read SFDP (0x5A) command
+    @param info geometry to fill in, left untouched on failure
+    @return 0 on success, an error code otherwise
+ */
+uint32_t sfdp_parse(sfdp_read_t read, sfdp_info_t *info);
+
+/** Select the largest erase type that starts at adr and fits in sz
+    @param info geometry filled in by sfdp_parse()
+    @param adr address to erase from
+    @param sz the amount of memory that may be erased
+    @return index of the erase type, -1 if none fits
+ */
+int32_t sfdp_erase_type(const sfdp_info_t *info, uint32_t adr, uint32_t sz);
+
+#ifdef __cplusplus
+  }
+#endif
+
+#endif
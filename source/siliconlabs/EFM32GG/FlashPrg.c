@@ -45,11 +45,85 @@
 #define FLASH_PAGE_SIZE       2048
 #endif
 
+/* Clock Management Unit */
+#define CMU_BASE             (0x400C8000UL)
+#define CMU_REG(offset)      (*((volatile uint32_t *)(CMU_BASE + (offset))))
+#define CMU_HFRCOCTRL        CMU_REG(0x00C)
+#define CMU_STATUS           CMU_REG(0x02C)
+#define CMU_HFCORECLKEN0     CMU_REG(0x040)
+
+#define CMU_STATUS_HFRCOSEL          (0x1UL << 10)
+#define CMU_HFCORECLKEN0_DMA         (0x1UL << 0)
+#define _CMU_HFRCOCTRL_BAND_TUNING   0x7FFUL
+#define CMU_HFRCOCTRL_BAND_28MHZ     (0x5UL << 8)
+
+#ifdef MSC_CLK_BOOST
+/* HFRCO 28 MHz band tuning value, calibrated in production */
+#define DEVINFO_HFRCOCAL1    (*((volatile uint32_t *) 0x0FE081E0UL))
+#define HFRCOCAL1_BAND28(v)  (((v) >> 8) & 0xFF)
+
+/* Flash timing runs from the 14 MHz AUXHFRCO: 1 us timebase, 14 * 1.1 + 1 cycles */
+#define MSC_TIMEBASE_AUX14M  (MSC_TIMEBASE_PERIOD_1US | ((14 * 11) / 10 + 1))
+
+static struct {
+  uint32_t boosted;
+  uint32_t hfrcoctrl;
+  uint32_t readctrl;
+  uint32_t timebase;
+} clk_saved;
+#endif
+
+#ifdef MSC_DMA_WRITE
+/* DMA controller (PL230), channel 0 feeds MSC->WDATA on the MSC WDATA request */
+#define DMA_BASE             (0x400C2000UL)
+#define DMA_REG(offset)      (*((volatile uint32_t *)(DMA_BASE + (offset))))
+#define DMA_CONFIG           DMA_REG(0x004)
+#define DMA_CTRLBASE         DMA_REG(0x008)
+#define DMA_CHUSEBURSTC      DMA_REG(0x01C)
+#define DMA_CHREQMASKC       DMA_REG(0x024)
+#define DMA_CHENS            DMA_REG(0x028)
+#define DMA_CHENC            DMA_REG(0x02C)
+#define DMA_CHALTC           DMA_REG(0x034)
+#define DMA_CHPRIC           DMA_REG(0x03C)
+#define DMA_CH0_CTRL         DMA_REG(0x1100)
+
+#define DMA_CONFIG_EN        (0x1UL << 0)
+#define DMA_CH_MSC_WDATA     (0x30UL << 16)     /* SOURCESEL MSC, SIGSEL WDATA */
+#define DMA_CH_MASK          (0x1UL << 0)
+
+/* Word source incrementing, word destination fixed, one word per request, basic cycle */
+#define DMA_DESC_CTRL(n)     ((3UL << 30) | (2UL << 28) | (2UL << 26) | (2UL << 24) | \
+                              (((n) - 1) << 4) | 1)
+#define DMA_MAX_WORDS        1024
+
+/* CTRLBASE has to be aligned to the size of the 12 channel control block */
+#define DMA_CTRL_ALIGN       512
+
+typedef struct {
+  volatile uint32_t *srcEnd;
+  volatile uint32_t *dstEnd;
+  volatile uint32_t ctrl;
+  volatile uint32_t user;
+} DmaDesc_TypeDef;
+
+static uint8_t dmaCtrlRam[DMA_CTRL_ALIGN + sizeof(DmaDesc_TypeDef)];
+static DmaDesc_TypeDef *dmaDesc;
+
+static struct {
+  uint32_t clken;
+  uint32_t config;
+  uint32_t ctrlbase;
+  uint32_t ch0ctrl;
+} dma_saved;
+#endif
+
 static msc_Return_TypeDef MscStatusWait( uint32_t mask, uint32_t value )
 {
   uint32_t status;
   int timeOut = MSC_PROGRAM_TIMEOUT;
+  msc_Return_TypeDef retVal = mscReturnTimeOut;
 
+  FLASH_STATS_BUSY_BEGIN();
   while (1)
   {
     status = MSC->STATUS;
@@ -60,22 +134,24 @@ static msc_Return_TypeDef MscStatusWait( uint32_t mask, uint32_t value )
       MSC->WRITECTRL &= ~(MSC_WRITECTRL_WREN | MSC_WRITECTRL_WDOUBLE);
 
       if ( status & MSC_STATUS_LOCKED )
-        return mscReturnLocked;
-
-      if ( status & MSC_STATUS_INVADDR )
-        return mscReturnInvalidAddr;
-
-      return mscReturnTimeOut;
+        retVal = mscReturnLocked;
+      else if ( status & MSC_STATUS_INVADDR )
+        retVal = mscReturnInvalidAddr;
+      break;
     }
 
     if ( ( status & mask ) == value )
-      return mscReturnOk;
+    {
+      retVal = mscReturnOk;
+      break;
+    }
 
     timeOut--;
     if ( timeOut == 0 )
       break;
   }
-  return mscReturnTimeOut;
+  FLASH_STATS_BUSY_END();
+  return retVal;
 }
 
 static msc_Return_TypeDef DoFlashCmd( uint32_t cmd )
@@ -84,6 +160,7 @@ static msc_Return_TypeDef DoFlashCmd( uint32_t cmd )
   return MscStatusWait( MSC_STATUS_BUSY, 0 );
 }
 
+#ifndef MSC_DMA_WRITE
 static msc_Return_TypeDef PgmWord( uint32_t addr, uint32_t data )
 {
   MSC->ADDRB    = addr;
@@ -117,6 +194,51 @@ static msc_Return_TypeDef PgmBurstDouble( uint32_t addr, uint32_t *p, uint32_t c
   }
   return mscReturnOk;
 }
+#endif
+
+#ifdef MSC_DMA_WRITE
+/* Program cnt bytes within one flash page, the DMA writes WDATA on each request */
+static msc_Return_TypeDef PgmDma( uint32_t addr, uint32_t *p, uint32_t cnt )
+{
+  msc_Return_TypeDef retVal;
+  uint32_t words   = cnt >> 2;
+  int      timeOut = MSC_PROGRAM_TIMEOUT;
+
+  if ( (retVal = MscStatusWait( MSC_STATUS_BUSY, 0 )) != mscReturnOk )
+    return retVal;
+
+  dmaDesc->srcEnd = p + words - 1;
+  dmaDesc->dstEnd = &MSC->WDATA;
+  dmaDesc->ctrl   = DMA_DESC_CTRL( words );
+
+  MSC->ADDRB    = addr;
+  MSC->WRITECMD = MSC_WRITECMD_LADDRIM;
+  if ( MSC->STATUS & ( MSC_STATUS_LOCKED | MSC_STATUS_INVADDR ) )
+    return MscStatusWait( MSC_STATUS_BUSY, 0 );
+
+  DMA_CHENS     = DMA_CH_MASK;
+  MSC->WRITECMD = MSC_WRITECMD_WRITETRIG;
+
+  /* Wait until the DMA has handed over the last word */
+  FLASH_STATS_BUSY_BEGIN();
+  while ( DMA_CHENS & DMA_CH_MASK )
+  {
+    if ( ( MSC->STATUS & ( MSC_STATUS_LOCKED | MSC_STATUS_INVADDR | MSC_STATUS_WORDTIMEOUT ) ) ||
+         ( --timeOut == 0 ) )
+    {
+      FLASH_STATS_BUSY_END();
+      DMA_CHENC = DMA_CH_MASK;
+      retVal = MscStatusWait( MSC_STATUS_BUSY, 0 );
+      return retVal != mscReturnOk ? retVal : mscReturnTimeOut;
+    }
+  }
+  FLASH_STATS_BUSY_END();
+
+  retVal = MscStatusWait( MSC_STATUS_BUSY, 0 );
+  MSC->WRITECMD = MSC_WRITECMD_WRITEEND;
+  return retVal;
+}
+#endif
 
 /*****************************************************************************
  *  Initialize Flash Programming Functions
@@ -130,6 +252,43 @@ uint32_t Init(uint32_t adr, uint32_t clk, uint32_t fnc)
   /* Unlock the MSC */
   MSC->LOCK = MSC_UNLOCK_CODE;
 
+#ifdef MSC_CLK_BOOST
+  /* Raise HFRCO to 28 MHz, only when the core runs from it */
+  clk_saved.boosted = 0;
+  if ( CMU_STATUS & CMU_STATUS_HFRCOSEL )
+  {
+    clk_saved.hfrcoctrl = CMU_HFRCOCTRL;
+    clk_saved.readctrl  = MSC->READCTRL;
+    clk_saved.timebase  = MSC->TIMEBASE;
+    clk_saved.boosted   = 1;
+
+    MSC->READCTRL = ( MSC->READCTRL & ~_MSC_READCTRL_MODE_MASK ) | MSC_READCTRL_MODE_WS1;
+    MSC->TIMEBASE = ( MSC->TIMEBASE & ~( _MSC_TIMEBASE_BASE_MASK | _MSC_TIMEBASE_PERIOD_MASK ) ) |
+                    MSC_TIMEBASE_AUX14M;
+    CMU_HFRCOCTRL = ( CMU_HFRCOCTRL & ~_CMU_HFRCOCTRL_BAND_TUNING ) |
+                    CMU_HFRCOCTRL_BAND_28MHZ | HFRCOCAL1_BAND28( DEVINFO_HFRCOCAL1 );
+  }
+#endif
+
+#ifdef MSC_DMA_WRITE
+  dma_saved.clken    = CMU_HFCORECLKEN0;
+  CMU_HFCORECLKEN0  |= CMU_HFCORECLKEN0_DMA;
+  dma_saved.config   = DMA_CONFIG;
+  dma_saved.ctrlbase = DMA_CTRLBASE;
+  dma_saved.ch0ctrl  = DMA_CH0_CTRL;
+
+  /* Only the primary descriptor of channel 0 is used */
+  dmaDesc = (DmaDesc_TypeDef *)( ( (uint32_t)dmaCtrlRam + DMA_CTRL_ALIGN - 1 ) & ~( DMA_CTRL_ALIGN - 1 ) );
+  DMA_CHENC       = DMA_CH_MASK;
+  DMA_CONFIG      = DMA_CONFIG_EN;
+  DMA_CTRLBASE    = (uint32_t)dmaDesc;
+  DMA_CHUSEBURSTC = DMA_CH_MASK;
+  DMA_CHREQMASKC  = DMA_CH_MASK;
+  DMA_CHALTC      = DMA_CH_MASK;
+  DMA_CHPRIC      = DMA_CH_MASK;
+  DMA_CH0_CTRL    = DMA_CH_MSC_WDATA;
+#endif
+
   return 0;
 }
 
@@ -143,6 +302,24 @@ uint32_t UnInit(uint32_t fnc)
 {
   /* Disable write in MSC */
   MSC->WRITECTRL &= ~(MSC_WRITECTRL_WREN | MSC_WRITECTRL_WDOUBLE);
+
+#ifdef MSC_DMA_WRITE
+  DMA_CHENC        = DMA_CH_MASK;
+  DMA_CH0_CTRL     = dma_saved.ch0ctrl;
+  DMA_CTRLBASE     = dma_saved.ctrlbase;
+  DMA_CONFIG       = dma_saved.config;
+  CMU_HFCORECLKEN0 = dma_saved.clken;
+#endif
+
+#ifdef MSC_CLK_BOOST
+  if ( clk_saved.boosted )
+  {
+    CMU_HFRCOCTRL = clk_saved.hfrcoctrl;
+    MSC->TIMEBASE = clk_saved.timebase;
+    MSC->READCTRL = clk_saved.readctrl;
+    clk_saved.boosted = 0;
+  }
+#endif
   return 0;
 }
 
@@ -206,19 +383,35 @@ uint32_t EraseSector(uint32_t adr)
 uint32_t ProgramPage(uint32_t adr, uint32_t sz, uint32_t *buf)
 {
   uint32_t burst;
+  uint8_t  *p = (uint8_t *)buf;
 
   sz = (sz + 3) & ~3;                     /* Make sure we are modulo 4. */
 
   MSC->WRITECTRL |= MSC_WRITECTRL_WREN;
 
+#ifdef MSC_DMA_WRITE
+  while ( sz )
+  {
+    /* Max burst len is up to next flash page boundary. */
+    burst = MIN( sz, ( ( adr + FLASH_PAGE_SIZE ) & FLASH_PAGE_MASK ) - adr );
+    burst = MIN( burst, DMA_MAX_WORDS * 4 );
+
+    if ( PgmDma( adr, (uint32_t*)p, burst ) != mscReturnOk )
+      return 1;
+
+    p   += burst;
+    adr += burst;
+    sz  -= burst;
+  }
+#else
   if ( sz > 7 )
   {
     if ( adr & 7 )    /* Start address not on 8 byte boundary ? */
     {
-      if ( PgmWord( adr, *(uint32_t*)buf ) != mscReturnOk )
+      if ( PgmWord( adr, *(uint32_t*)p ) != mscReturnOk )
         return 1;
 
-      buf += 4;
+      p   += 4;
       adr += 4;
       sz  -= 4;
     }
@@ -232,10 +425,10 @@ uint32_t ProgramPage(uint32_t adr, uint32_t sz, uint32_t *buf)
       if ( burst & 4 )    /* Make sure we are modulo 8. */
         burst -= 4;
 
-      if ( PgmBurstDouble( adr, (uint32_t*)buf, burst ) != mscReturnOk )
+      if ( PgmBurstDouble( adr, (uint32_t*)p, burst ) != mscReturnOk )
         return 1;
 
-      buf += burst;
+      p   += burst;
       adr += burst;
       sz  -= burst;
     }
@@ -247,9 +440,10 @@ uint32_t ProgramPage(uint32_t adr, uint32_t sz, uint32_t *buf)
 
   if ( sz )
   {
-    if ( PgmWord( adr, *(uint32_t*)buf ) != mscReturnOk )
+    if ( PgmWord( adr, *(uint32_t*)p ) != mscReturnOk )
       return 1;
   }
+#endif
 
   MSC->WRITECTRL &= ~MSC_WRITECTRL_WREN;
 
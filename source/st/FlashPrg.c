@@ -155,7 +155,9 @@ uint32_t EraseSector (uint32_t adr) {
      
   M32(adr) = 0x00000000;			            // write '0' to the first address to erase page
 
+  FLASH_STATS_BUSY_BEGIN();
   while (FLASH->SR & FLASH_BSY);
+  FLASH_STATS_BUSY_END();
 
   // Check for Errors
   if (FLASH->SR & (FLASH_ERRs)) {
@@ -232,7 +234,9 @@ uint32_t ProgramPage (uint32_t adr, uint32_t sz, uint32_t *buf) {
   FLASH->PECR |= FLASH_FPRG;			// Half Page programming mode enabled
   FLASH->PECR |= FLASH_PROG;                    // Program memory selected
 
+  FLASH_STATS_BUSY_BEGIN();
   while (FLASH->SR & FLASH_BSY);
+  FLASH_STATS_BUSY_END();
 
   // write first half page
   for (i = 0, j = 0; i < 128; i += 4, j++) {
@@ -267,7 +271,9 @@ uint32_t ProgramPage (uint32_t adr, uint32_t sz, uint32_t *buf) {
   FLASH->PECR |= FLASH_FPRG;			// Half Page programming mode enabled
   FLASH->PECR |= FLASH_PROG;                    // Program memory selected
 
+  FLASH_STATS_BUSY_BEGIN();
   while (FLASH->SR & FLASH_BSY);
+  FLASH_STATS_BUSY_END();
 
   // write second half page
   for (i = 128, j = 32; i < 256; i += 4, j++) {
@@ -244,9 +244,11 @@ int EraseChip (void) {
 #endif
   FLASH->CR |=  FLASH_STRT;                             // Start Erase
 
+  FLASH_STATS_BUSY_BEGIN();
   while (FLASH->SR & FLASH_BSY) {
     IWDG->KR = 0xAAAA;                                  // Reload IWDG
   }
+  FLASH_STATS_BUSY_END();
 
   FLASH->CR &= ~FLASH_MER;                              // Mass Erase Disabled
 #ifdef STM32F4xx_2048
@@ -300,9 +302,11 @@ int EraseSector (unsigned long adr) {
   FLASH->CR |=  ((n << FLASH_SNB_POS) & FLASH_SNB_MSK); // Sector Number
   FLASH->CR |=  FLASH_STRT;                             // Start Erase
 
+  FLASH_STATS_BUSY_BEGIN();
   while (FLASH->SR & FLASH_BSY) {
     IWDG->KR = 0xAAAA;                                  // Reload IWDG
   }
+  FLASH_STATS_BUSY_END();
 
   FLASH->CR &= ~FLASH_SER;                              // Page Erase Disabled 
 
@@ -345,7 +349,9 @@ int ProgramPage (unsigned long adr, unsigned long sz, unsigned char *buf) {
                   FLASH_PSIZE_Word);                    // Programming Enabled (Word)
 
     M32(adr) = *((u32 *)buf);                           // Program Double Word
+    FLASH_STATS_BUSY_BEGIN();
     while (FLASH->SR & FLASH_BSY);
+    FLASH_STATS_BUSY_END();
 
     FLASH->CR &= ~FLASH_PG;                             // Programming Disabled
 
@@ -382,7 +388,9 @@ int ProgramPage (unsigned long adr, unsigned long sz, unsigned char *buf) {
   FLASH->OPTCR1 = (optcr1 & 0x0FFF0000);                 // program values
 #endif
   FLASH->OPTCR  = (optcr  & 0x0FFFFFFC) | FLASH_OPTSTRT; // program values
+  FLASH_STATS_BUSY_BEGIN();
   while (FLASH->SR & FLASH_BSY);
+  FLASH_STATS_BUSY_END();
 
   if (FLASH->SR & FLASH_PGERR) {                        // Check for Error
     FLASH->SR |= FLASH_PGERR;                           // Reset Error Flags
@@ -404,7 +412,9 @@ int ProgramPage (unsigned long adr, unsigned long sz, unsigned char *buf) {
   FLASH->SR    |= FLASH_PGERR;                          // Reset Error Flags
 
   FLASH->OPTCR  = optcr | FLASH_OPTSTRT;                // program values
+  FLASH_STATS_BUSY_BEGIN();
   while (FLASH->SR & FLASH_BSY);
+  FLASH_STATS_BUSY_END();
 
   if (FLASH->SR & FLASH_PGERR) {                        // Check for Error
     FLASH->SR |= FLASH_PGERR;                           // Reset Error Flags
@@ -237,9 +237,11 @@ int EraseChip (void) {
   M32(0x1FF80008) = 0xFFFF0000;                 // unprotect sectors
   M32(0x1FF80008) = 0xFFFF0000;                 // unprotect sectors
 
+  FLASH_STATS_BUSY_BEGIN();
   while (FLASH->SR & FLASH_BSY) {
     IWDG->KR = 0xAAAA;                          // Reload IWDG
   }
+  FLASH_STATS_BUSY_END();
 
   // Check for Errors
   if (FLASH->SR & (FLASH_ERRs)) {
@@ -266,9 +268,11 @@ int EraseSector (unsigned long adr) {
      
   M32(adr) = 0x00000000;                        // write '0' to the first address to erase page
 
+  FLASH_STATS_BUSY_BEGIN();
   while (FLASH->SR & FLASH_BSY) {
     IWDG->KR = 0xAAAA;                          // Reload IWDG
   }
+  FLASH_STATS_BUSY_END();
 
   FLASH->PECR &= ~FLASH_ERASE;                  // Page or Double Word Erase disabled
   FLASH->PECR &= ~FLASH_PROG;                   // Program memory deselected   
@@ -303,9 +307,11 @@ int EraseSector (unsigned long adr) {
   while (cnt) {
     M32(adr) = 0x00000000;                      // write '0' to the first address to erase page
 
+    FLASH_STATS_BUSY_BEGIN();
     while (FLASH->SR & FLASH_BSY) {
       IWDG->KR = 0xAAAA;                        // Reload IWDG
     }
+    FLASH_STATS_BUSY_END();
 
     if (FLASH->SR & (FLASH_ERRs)) {            // Check for Errors
       FLASH->SR |= FLASH_ERRs;                 // clear error flags
@@ -366,9 +372,11 @@ int ProgramPage (unsigned long adr, unsigned long sz, unsigned char *buf) {
        cnt -= 4;                               
     }                                          
                                                
+    FLASH_STATS_BUSY_BEGIN();
     while (FLASH->SR & FLASH_BSY) {            
       IWDG->KR = 0xAAAA;                       // Reload IWDG
     }                                          
+    FLASH_STATS_BUSY_END();
                                                
     if (FLASH->SR & (FLASH_ERRs)) {            // Check for Errors
       FLASH->SR |= FLASH_ERRs;                 // clear error flags
@@ -397,9 +405,11 @@ int ProgramPage (unsigned long adr, unsigned long sz, unsigned char *buf) {
       M32(adr) = *((unsigned long *)buf);// Program Word
     }
 
+    FLASH_STATS_BUSY_BEGIN();
     while (FLASH->SR & FLASH_BSY) {
       IWDG->KR = 0xAAAA;                        // Reload IWDG
     }
+    FLASH_STATS_BUSY_END();
 
     if (FLASH->SR & (FLASH_ERRs)) {
       FLASH->SR |= FLASH_ERRs;                  // clear error flags
@@ -427,9 +437,11 @@ int ProgramPage (unsigned long adr, unsigned long sz, unsigned char *buf) {
 
     M32(adr) = *((unsigned long *)buf);         // Program Word
 
+    FLASH_STATS_BUSY_BEGIN();
     while (FLASH->SR & FLASH_BSY) {
       IWDG->KR = 0xAAAA;                        // Reload IWDG
     }
+    FLASH_STATS_BUSY_END();
     adr += 4;
     buf += 4;
     sz  -= 4;
@@ -450,9 +462,11 @@ unsigned long Verify (unsigned long adr, unsigned long sz, unsigned char *buf) {
       return(adr);                              // failed
     }
 
+    FLASH_STATS_BUSY_BEGIN();
     while (FLASH->SR & FLASH_BSY) {
       IWDG->KR = 0xAAAA;                        // Reload IWDG
     }
+    FLASH_STATS_BUSY_END();
 
     adr += 4;
     buf += 4;
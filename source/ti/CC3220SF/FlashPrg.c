@@ -60,12 +60,16 @@ void UtilsDelay(unsigned long ulCount)
           "    BNE    Count");
 }
 
-uint32_t Init(uint32_t adr, uint32_t clk, uint32_t fnc)
+//*****************************************************************************
+// Marker left in RAM once the SoC setup below has run, the CMSIS flow calls
+// Init separately for erase, program and verify
+//*****************************************************************************
+#define SOC_SETUP_MARKER        0x43433332
+
+static uint32_t soc_setup;
+
+static void SocSetup(void)
 {
-    // Called to configure the SoC. Should enable clocks
-    //  watchdogs, peripherals and anything else needed to
-    //  access or program memory. Fnc parameter has meaning
-    //  but currently isnt used in MSC programming routines
     unsigned long ulRegValue;
     //
     // DIG DCDC LPDS ECO Enable
@@ -76,12 +80,17 @@ uint32_t Init(uint32_t adr, uint32_t clk, uint32_t fnc)
     // any hibernate wakeup source will be kept maked until the device enters
     // hibernate completely (analog + digital)
     //
+    // The bit survives resets, skip the slow HIB register write once set.
+    //
     ulRegValue = HWREG(HIB3P3_BASE  + HIB3P3_O_MEM_HIB_REG0);
-    UtilsDelay((80*200)/3);
+    if((ulRegValue & (1<<4)) == 0)
+    {
+        UtilsDelay((80*200)/3);
 
-    //PRCMHIBRegWrite(HIB3P3_BASE + HIB3P3_O_MEM_HIB_REG0, ulRegValue | (1<<4));
-    HWREG(HIB3P3_BASE + HIB3P3_O_MEM_HIB_REG0) = ulRegValue | (1<<4);
-    UtilsDelay((80*200)/3);
+        //PRCMHIBRegWrite(HIB3P3_BASE + HIB3P3_O_MEM_HIB_REG0, ulRegValue | (1<<4));
+        HWREG(HIB3P3_BASE + HIB3P3_O_MEM_HIB_REG0) = ulRegValue | (1<<4);
+        UtilsDelay((80*200)/3);
+    }
 
     //
     // Handling the clock switching (for 1.32 only)
@@ -262,6 +271,29 @@ uint32_t Init(uint32_t adr, uint32_t clk, uint32_t fnc)
             HWREG(0x4402F010) &= 0x0FFFFFFF; // <31:28> = 0
         }
     }
+}
+
+uint32_t Init(uint32_t adr, uint32_t clk, uint32_t fnc)
+{
+    // Called to configure the SoC. Should enable clocks
+    //  watchdogs, peripherals and anything else needed to
+    //  access or program memory. Fnc parameter has meaning
+    //  but currently isnt used in MSC programming routines
+    //
+    // Heavy PRCM setup only on the first call of the session.
+    //
+    if(soc_setup != SOC_SETUP_MARKER)
+    {
+        SocSetup();
+        soc_setup = SOC_SETUP_MARKER;
+    }
+    //
+    // Clear the flash access and error interrupts.
+    //
+    HWREG(FLASH_CONTROL_BASE + FLASH_CTRL_O_FCMISC) =
+      (FLASH_CTRL_FCMISC_AMISC | FLASH_CTRL_FCMISC_VOLTMISC |
+       FLASH_CTRL_FCMISC_ERMISC | FLASH_CTRL_FCMISC_INVDMISC |
+       FLASH_CTRL_FCMISC_PROGMISC);
     //
     // Success.
     //
@@ -294,9 +326,11 @@ uint32_t EraseChip(void)
     //
     // Wait until mass erase completes.
     //
+    FLASH_STATS_BUSY_BEGIN();
     while(HWREG(FLASH_CONTROL_BASE + FLASH_CTRL_O_FMC) & FLASH_CTRL_FMC_MERASE1)
     {
     }
+    FLASH_STATS_BUSY_END();
     //
     // Return an error if an access violation or erase error occurred.
     //
@@ -334,9 +368,11 @@ uint32_t EraseSector(uint32_t adr)
     //
     // Wait until the block has been erased.
     //
+    FLASH_STATS_BUSY_BEGIN();
     while(HWREG(FLASH_CONTROL_BASE + FLASH_CTRL_O_FMC) & FLASH_CTRL_FMC_ERASE)
     {
     }
+    FLASH_STATS_BUSY_END();
     //
     // Return an error if an access violation or erase error occurred.
     //
@@ -355,6 +391,7 @@ uint32_t EraseSector(uint32_t adr)
 uint32_t ProgramPage(uint32_t adr, uint32_t sz, uint32_t *buf)
 {
     // Program the contents of buf starting at adr for length of sz
+    volatile unsigned long *pulFWB;
     //
     // Check the arguments.
     //
@@ -367,8 +404,9 @@ uint32_t ProgramPage(uint32_t adr, uint32_t sz, uint32_t *buf)
     HWREG(FLASH_CONTROL_BASE + FLASH_CTRL_O_FCMISC)
       = (FLASH_CTRL_FCMISC_AMISC | FLASH_CTRL_FCMISC_VOLTMISC |
                            FLASH_CTRL_FCMISC_INVDMISC | FLASH_CTRL_FCMISC_PROGMISC);
+    pulFWB = (volatile unsigned long *)(FLASH_CONTROL_BASE + FLASH_CTRL_O_FWBN);
     //
-    // See if this device has a write buffer.
+    // Program one 32-word write buffer block per pass, pages may span many.
     //
     while(sz)
     {
@@ -376,20 +414,38 @@ uint32_t ProgramPage(uint32_t adr, uint32_t sz, uint32_t *buf)
         // Set the address of this block of words. for 1 MB
         //
         HWREG(FLASH_CONTROL_BASE + FLASH_CTRL_O_FMA) = adr & ~(0x7F);
-        //
-        // Loop over the words in this 32-word block.
-        //
-        while(((adr & 0x7C) ||
-               (HWREG(FLASH_CONTROL_BASE + FLASH_CTRL_O_FWBVAL) == 0)) &&
-               (sz != 0))
+        if(((adr & 0x7C) == 0) && (sz >= 0x80))
+        {
+            //
+            // Whole block, fill the write buffer without per-word checks.
+            //
+            for(int i = 0; i < 32; i += 4)
+            {
+                pulFWB[i + 0] = buf[i + 0];
+                pulFWB[i + 1] = buf[i + 1];
+                pulFWB[i + 2] = buf[i + 2];
+                pulFWB[i + 3] = buf[i + 3];
+            }
+            buf += 32;
+            adr += 0x80;
+            sz -= 0x80;
+        }
+        else
         {
             //
-            // Write this word into the write buffer.
+            // Loop over the words in this 32-word block.
             //
-            HWREG(FLASH_CONTROL_BASE + FLASH_CTRL_O_FWBN
-                  + (adr & 0x7C)) = *buf++;
-            adr += 4;
-            sz -= 4;
+            while(((adr & 0x7C) ||
+                   (HWREG(FLASH_CONTROL_BASE + FLASH_CTRL_O_FWBVAL) == 0)) &&
+                   (sz != 0))
+            {
+                //
+                // Write this word into the write buffer.
+                //
+                pulFWB[(adr & 0x7C) >> 2] = *buf++;
+                adr += 4;
+                sz -= 4;
+            }
         }
         //
         // Program the contents of the write buffer into flash.
@@ -399,9 +455,21 @@ uint32_t ProgramPage(uint32_t adr, uint32_t sz, uint32_t *buf)
         //
         // Wait until the write buffer has been programmed.
         //
+        FLASH_STATS_BUSY_BEGIN();
         while(HWREG(FLASH_CONTROL_BASE + FLASH_CTRL_O_FMC2) & FLASH_CTRL_FMC2_WRBUF)
         {
         }
+        FLASH_STATS_BUSY_END();
+        //
+        // Return an error if an access violation, invalid data or
+        // program verify error occurred.
+        //
+        if(HWREG(FLASH_CONTROL_BASE + FLASH_CTRL_O_FCRIS)
+           & (FLASH_CTRL_FCRIS_ARIS | FLASH_CTRL_FCRIS_VOLTRIS |
+              FLASH_CTRL_FCRIS_INVDRIS | FLASH_CTRL_FCRIS_PROGRIS))
+        {
+            return(1);
+        }
     }
     //
     // Success.
@@ -31,7 +31,8 @@ struct FlashDevice const FlashDevice = {
     0x00000000,                 // Reserved, must be 0
     0xFF,                       // Initial Content of Erased Memory
     0x00000064,                 // Program Page Timeout 100 mSec
-    0x00000320,                 // Erase Sector Timeout 800 mSec
+    0x00000BB8,                 // Erase Sector Timeout 3000 mSec (64kB block)
     {{0x00001000, 0x00000000},  // Sector Size {4kB, starting at address 0}
+    {0x00010000, 0x00010000},   // Sector Size {64kB, starting at address 64kB}
     {SECTOR_END}}
 };
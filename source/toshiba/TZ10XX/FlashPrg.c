@@ -18,6 +18,7 @@
 
 #include "FlashOS.h"
 #include "FlashPrg.h"
+#include "sfdp.h"
 
 /* 
  * TZ10xx on chip NOR flash support functions. 
@@ -30,6 +31,23 @@
 
 #define REG_SPIC(offset)    (*((volatile uint32_t *)(SPIC_BASE_ADDR + (offset))))
 #define REG_GCNF(offset)    (*((volatile uint32_t *)(GCNF_BASE_ADDR + (offset))))
+#define SFDP_CHUNK          (32)
+
+extern struct FlashDevice const FlashDevice;
+
+/* Flash geometry, replaced by the SFDP tables of the part at the first Init */
+static sfdp_info_t nor = {
+    0x00100000,                 // 1MB
+    0x00000100,                 // 256 byte pages
+    {0x00001000, 0, 0, 0},      // 4KB sector erase
+    {0x20, 0, 0, 0},
+    3,                          // 3 address bytes
+    0x02,                       // Page program
+    0x32,                       // Quad page program
+    0
+};
+static uint32_t nor_probed;
+
 
 /* local functions */
 
@@ -42,14 +60,14 @@ static void wait(uint32_t usec)
     } while (--cnt);
 }
 
-static int readCommand(uint32_t command, uint32_t *reg_val)
+static int readTransfer(uint32_t reg_acctrl, uint32_t command)
 {
     uint32_t intr_stat;
     uint32_t cnt;
-    // Read status command.
+    // Read command.
     REG_SPIC(0x028) = 0x00000100;
     REG_SPIC(0x02C) = 0x00000400;
-    REG_SPIC(0x030) = 0x00000230;
+    REG_SPIC(0x030) = reg_acctrl;
     REG_SPIC(0x100) = command;
     REG_SPIC(0x034) = 0x00000001;
     // Wait for done.
@@ -65,14 +83,38 @@ static int readCommand(uint32_t command, uint32_t *reg_val)
         return 1;
     }
     REG_SPIC(0x0A0) = 0x0000000F;   // Clear flags.
+    return 0;
+}
+
+static int readCommand(uint32_t command, uint32_t *reg_val)
+{
+    // Read status command.
+    if (readTransfer(0x00000230, command) != 0) {
+        return 1;
+    }
     *reg_val = REG_SPIC(0x200);     // Read buffer.
     return 0;
 
 }
 
-static inline int readStatus1(uint32_t *status)
+static uint32_t readSFDP(uint32_t adr, uint8_t *buf, uint32_t sz)
 {
-    return readCommand(0x00000005, status);
+    uint32_t n;
+
+    while (sz > 0) {
+        n = (sz > SFDP_CHUNK) ? SFDP_CHUNK : sz;
+        // Read SFDP command with 3 address bytes, the dummy byte is
+        // received as the first of n + 1 data bytes.
+        if (readTransfer(0x00030230 | (n << 24), (__rev(adr) | 0x5A)) != 0) {
+            return 1;
+        }
+        for (uint32_t i = 1; i <= n; i++) {
+            *buf++ = REG_SPIC(0x200 + (i & ~3)) >> (8 * (i & 3));
+        }
+        adr += n;
+        sz -= n;
+    }
+    return 0;
 }
 
 static inline int readStatus2(uint32_t *status)
@@ -111,42 +153,56 @@ static int writeCommand(uint32_t reg_ioctrl, uint32_t reg_acctrl, uint32_t comma
     return 0;
 }
 
-static int prepareWrite(void)
+static int pollStatus1(uint32_t mask, uint32_t value, uint32_t limit)
 {
-    uint32_t intr_stat;
     uint32_t cnt;
-    // Write Enable command.
-    if (writeCommand(0x00000100, 0x00000310, 0x00000006) != 0) {
-        return 1;
-    }
-    // Wait for change state.
-    for (cnt = TIME_LIMIT; cnt > 0; --cnt) {
-        if (readStatus1(&intr_stat) != 0) {
+    uint32_t wait_cnt;
+
+    // Read status register 1 command, set up once and restarted per poll.
+    REG_SPIC(0x028) = 0x00000100;
+    REG_SPIC(0x02C) = 0x00000400;
+    REG_SPIC(0x030) = 0x00000230;
+    REG_SPIC(0x100) = 0x00000005;
+    for (cnt = limit; cnt > 0; --cnt) {
+        REG_SPIC(0x034) = 0x00000001;
+        // Wait for done.
+        for (wait_cnt = TIME_LIMIT; wait_cnt > 0; --wait_cnt) {
+            if (REG_SPIC(0x0A0) & 0x00000001) {
+                // Detect PrgRdEnd flag.
+                break;
+            }
+        }
+        if (wait_cnt == 0) {
+            // Timeout
             return 1;
         }
-        if (intr_stat & 0x00000002) {
-            // Detect PrgWrEnd flag.
-            break;
+        REG_SPIC(0x0A0) = 0x0000000F;   // Clear flags.
+        if ((REG_SPIC(0x200) & mask) == value) {
+            return 0;
         }
     }
-    return 0;
+    return 1;
 }
 
-static int polling(void)
+static int prepareWrite(void)
 {
-    uint32_t intr_stat;
-    uint32_t cnt;
-
-    for (cnt = TIME_LIMIT; cnt > 0; --cnt) {
-        if (readStatus1(&intr_stat) != 0) {
-            return 1;
-        }
-        if ((intr_stat & 0x00000001) == 0) {
-            break;
-        }
-        for (int i = 0; i < 100; i++);
+    // Write Enable command.
+    if (writeCommand(0x00000100, 0x00000310, 0x00000006) != 0) {
+        return 1;
     }
-    return 0;
+    // Wait for WEL bit set.
+    return pollStatus1(0x00000002, 0x00000002, TIME_LIMIT);
+}
+
+static int polling(uint32_t limit_ms)
+{
+    int ret;
+
+    // Wait for BUSY bit cleared, a status poll takes more than 1 usec.
+    FLASH_STATS_BUSY_BEGIN();
+    ret = pollStatus1(0x00000001, 0x00000000, limit_ms * 1000);
+    FLASH_STATS_BUSY_END();
+    return ret;
 }
 
 /* FlashAlgo interface */
@@ -156,6 +212,15 @@ uint32_t Init(uint32_t adr, uint32_t clk, uint32_t fnc)
     REG_GCNF(0x154) = 0;
     if (fnc == 3) {
         REG_SPIC(0x050) = 1;
+    } else if (!nor_probed) {
+        // Parts without SFDP keep the default geometry.
+        sfdp_parse(readSFDP, &nor);
+        nor_probed = 1;
+    }
+    // SPIC commands here carry 3 address bytes, and the part has to
+    // cover what FlashDevice tells the host.
+    if (nor.addr_bytes != 3 || nor.size < FlashDevice.szDev) {
+        return 1;
     }
     return 0;
 }
@@ -167,8 +232,6 @@ uint32_t UnInit(uint32_t fnc)
 
 uint32_t EraseChip(void)
 {
-    uint32_t intr_stat;
-    
     if (prepareWrite() != 0) {
         return 1;
     }
@@ -178,37 +241,51 @@ uint32_t EraseChip(void)
         return 1;
     }
     // Wait 'BUSY' bit cleard.
-    for (int i = 0; i < TIME_LIMIT_MS; i++) {
-        if (readStatus1(&intr_stat) != 0) {
-            return 1;
-        }
-        if ((intr_stat & 0x00000001) == 0) {
-            // BUSY bit cleard.
-            break;
-        }
-        wait(1000); // 1ms;
+    if (polling(TIME_LIMIT_MS) != 0) {
+        return 1;
     }
-    
     return 0;
 }
 
-uint32_t EraseSector(uint32_t adr)
+static uint32_t sectorSize(uint32_t adr)
 {
-    if (prepareWrite() != 0) {
-        return 1;
-    }
-    wait(8);
-    // Write chip erase command.
-    if (writeCommand(0x00000100, 0x00030310, (__rev(adr) | 0x20)) != 0) {
-        return 1;
+    const struct FlashSector *s = FlashDevice.sectors;
+
+    while (s[1].adrSector != 0xFFFFFFFF && s[1].adrSector <= adr) {
+        s++;
     }
-    if (polling() != 0) {
-        return 1;
+    return s->szSector;
+}
+
+uint32_t EraseSector(uint32_t adr)
+{
+    uint32_t end = adr + sectorSize(adr);
+    int32_t type;
+
+    // FlashDevice describes 64kB blocks above the first 64kB, erased with
+    // the block opcode of the part. Parts without it take several commands.
+    while (adr < end) {
+        type = sfdp_erase_type(&nor, adr, end - adr);
+        if (type < 0) {
+            return 1;
+        }
+        if (prepareWrite() != 0) {
+            return 1;
+        }
+        wait(8);
+        // Write sector/block erase command.
+        if (writeCommand(0x00000100, 0x00030310, (__rev(adr) | nor.erase_op[type])) != 0) {
+            return 1;
+        }
+        if (polling(FlashDevice.toErase) != 0) {
+            return 1;
+        }
+        adr += nor.erase_size[type];
     }
     return 0;
 }
 
-uint32_t ProgramPage(uint32_t adr, uint32_t sz, uint32_t *buf)
+static int programChunk(uint32_t adr, uint32_t sz, uint32_t *buf)
 {
     uint32_t stat;
     uint32_t offset;
@@ -222,7 +299,7 @@ uint32_t ProgramPage(uint32_t adr, uint32_t sz, uint32_t *buf)
     if (readStatus2(&stat) != 0) {
         return 1;
     }
-    if (stat & 0x00000002) {
+    if ((stat & 0x00000002) && nor.quad_prog_op != 0) {
         /* SPI quad access mode. */
         // Configuration of `PrgBufIOCtrl'
         REG_SPIC(0x028) = 0x00000102;
@@ -231,7 +308,7 @@ uint32_t ProgramPage(uint32_t adr, uint32_t sz, uint32_t *buf)
         // Configuration of `PrgAccCtrl'
         REG_SPIC(0x030) = (0x00030330 | ((sz - 1) << 24));
         // Write `Write page program' command to SPIC PrimaryBuffer.
-        REG_SPIC(0x100) = (__rev(adr) | 0x32);
+        REG_SPIC(0x100) = (__rev(adr) | nor.quad_prog_op);
     } else {
         /* SPI single access mode. */
         // Configuration of `PrgBufIOCtrl'
@@ -241,7 +318,7 @@ uint32_t ProgramPage(uint32_t adr, uint32_t sz, uint32_t *buf)
         // Configuration of `PrgAccCtrl'
         REG_SPIC(0x030) = (0x00030330 | ((sz - 1) << 24));
         // Write `Write page program' command to SPIC PrimaryBuffer.
-        REG_SPIC(0x100) = (__rev(adr) | 0x02);
+        REG_SPIC(0x100) = (__rev(adr) | nor.prog_op);
     }
     // Copy from SRAM to SPIC SecondaryBuffer.
     offset = sz & 0xfffffffc;
@@ -268,9 +345,29 @@ uint32_t ProgramPage(uint32_t adr, uint32_t sz, uint32_t *buf)
         return 1;
     }
     // Wait for BUSY flag cleard.
-    if (polling() != 0) {
+    if (polling(FlashDevice.toProg) != 0) {
         return 1;
     }
 
     return 0;
 }
+
+uint32_t ProgramPage(uint32_t adr, uint32_t sz, uint32_t *buf)
+{
+    uint32_t n;
+
+    // Split at the page boundaries of the part.
+    while (sz > 0) {
+        n = nor.page_size - (adr & (nor.page_size - 1));
+        if (n > sz) {
+            n = sz;
+        }
+        if (programChunk(adr, n, buf) != 0) {
+            return 1;
+        }
+        adr += n;
+        buf += n >> 2;
+        sz -= n;
+    }
+    return 0;
+}
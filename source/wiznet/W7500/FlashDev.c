@@ -25,13 +25,13 @@ struct FlashDevice const FlashDevice  =  {
     ONCHIP,                     // Device Type
     0x00000000,                 // Flash start address
     0x00020000,                 // Flash total size (128 KB // + 1 kB)
-    0x00000100,                 // Programming Page Size
+    0x00001000,                 // Programming Page Size
     0,                          // Reserved, must be 0
     0xFF,                       // Initial Content of Erased Memory
     100,                        // Program Page Timeout 100 mSec
     3000,                       // Erase Sector Timeout 3000 mSec
 
-    0x00000100, 0x000000,       // Sector Size  256bytes (512Sectors,128KB)
+    0x00001000, 0x000000,       // Sector Size  4KB blocks (32Sectors,128KB)
     SECTOR_END                  // Marks end of sector table
 };
 
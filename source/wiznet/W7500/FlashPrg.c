@@ -31,17 +31,47 @@
 #define IAP_PROG_DAT1   (IAP_PROG + 1)
 #define IAP_PROG_CODE   (IAP_PROG + 2)
 
+#define BLOCK_SIZE      0x1000      // FlashDevice sectors are IAP blocks
+#define FLASH_SIZE      0x20000
+
+/* The ROM IAP routine does not return a status, the result is read back */
 void DO_IAP(unsigned long id, unsigned long dst_addr, unsigned char* src_addr, unsigned long size)
 {
-    (*((volatile uint32_t *)(0xE000ED04))) = 0x00000000; // ICSR(Interrupt Control and State Register) of SCB(SystemControlBlock)
-    (*((volatile uint32_t *)(0xE000E180))) = 0xffffffff; // ICER(Interrupt Clear-enable Register) of NVIC(Nested Vectored Interrupt Controller)
-    (*((volatile uint32_t *)(0xE000E010))) &= ~(0x01);   // SYST_CSR ( SystTick Control and Status Register)
-    
+    FLASH_STATS_BUSY_BEGIN();
     ((void(*)(unsigned long,unsigned long,unsigned char*,unsigned long))IAP_ENTRY)(id,dst_addr,src_addr,size);
+    FLASH_STATS_BUSY_END();
+}
+
+static int IsBlank (unsigned long adr, unsigned long sz)
+{
+    volatile unsigned long *p = (volatile unsigned long *)adr;
+
+    for (; sz >= 4; sz -= 4) {
+        if (*p++ != 0xFFFFFFFF) {
+            return (0);
+        }
+    }
+    return (1);
+}
+
+static int IsEqual (unsigned long adr, unsigned long sz, unsigned char *buf)
+{
+    volatile unsigned char *p = (volatile unsigned char *)adr;
+
+    while (sz--) {
+        if (*p++ != *buf++) {
+            return (0);
+        }
+    }
+    return (1);
 }
 
 int Init (unsigned long adr, unsigned long clk, unsigned long fnc) 
 {
+    // The IAP routine must not be interrupted, disable everything once per session
+    (*((volatile uint32_t *)(0xE000ED04))) = 0x00000000; // ICSR(Interrupt Control and State Register) of SCB(SystemControlBlock)
+    (*((volatile uint32_t *)(0xE000E180))) = 0xffffffff; // ICER(Interrupt Clear-enable Register) of NVIC(Nested Vectored Interrupt Controller)
+    (*((volatile uint32_t *)(0xE000E010))) &= ~(0x01);   // SYST_CSR ( SystTick Control and Status Register)
 	return(0);
 }
 
@@ -53,20 +83,29 @@ int UnInit (unsigned long fnc)
 int EraseChip (void) 
 {
     DO_IAP(IAP_ERAS_CHIP,0,0,0);
+    if (!IsBlank(0, FLASH_SIZE)) {
+        return (1);
+    }
     return (0);                                    // Finished without Errors
 }
 
 int EraseSector (unsigned long adr) 
 {
-    DO_IAP(IAP_ERAS_SECT,adr,0,0);
-    
+    // One ROM call per 4KB block instead of 16 sector erases
+    DO_IAP(IAP_ERAS_BLCK,adr,0,0);
+    if (!IsBlank(adr, BLOCK_SIZE)) {
+        return (1);
+    }
     return (0);                                  // Finished without Errors
 }
 
 int ProgramPage (unsigned long adr, unsigned long sz, unsigned char *buf) 
 {
-     DO_IAP(IAP_PROG_CODE,adr,(unsigned char*)buf,sz);
+    // Whole pages go to the ROM in one call
+    DO_IAP(IAP_PROG_CODE,adr,(unsigned char*)buf,sz);
 
+    if (!IsEqual(adr, sz, buf)) {
+        return (1);
+    }
     return (0);                                  // Finished without Errors
 }
-